@@ -50,6 +50,7 @@
 #include <stdarg.h>
 
 #include <unistd.h>
+#include <getopt.h>
 #include <string.h>
 #include <time.h>
 
@@ -62,6 +63,22 @@
 #include <sys/wait.h>
 #include <sys/ioctl.h>
 
+#include "mm-solver.h"
+#include "mm-book.h"
+#include "mm-gentree.h"
+#include "mm-rng.h"
+#include "mm-stats.h"
+#include "mm-trace.h"
+#include "mm-clock.h"
+#include "mm-sim.h"
+#include "mm-selftest.h"
+#include "mm-glyph.h"
+#include "mm-log.h"
+#include "mm-rt.h"
+#include "mm-input.h"
+#include "mm-keypad.h"
+#include "mm-lcdemu.h"
+
 /* --------------------------------------------------------------------------- */
 /* Config settings */
 /* you can use CPP flags to e.g. print extra debugging messages */
@@ -81,11 +98,27 @@
 // delay for loop iterations (mainly), in ms
 #define DELAY 200       // in mili-seconds: 0.2s
 #define TIMEOUT 3000000 // in micro-seconds: 3s
+#define WINDOW 5000     // input window for each peg, in ms
 // =======================================================
 // APP constants   ---------------------------------
+// Both can be set at build time, e.g. make LEN=4 COLS=6
+#ifndef COLS
 #define COLS 3 // Number of colours
+#endif
+#ifndef SEQL
 #define SEQL 3 // Number of the length of the sequence
-// We can modify the seql value to any number
+#endif
+// wakeups per run of the jitter benchmark (option --jitter), 1 ms apart
+#define JITTER_LOOPS 5000
+#define IO_BENCH_LOOPS 1000000 // GPIO accesses per variant in --io-bench
+#define IO_BENCH_CHARS 4096
+#define IO_BENCH_REDRAWS 64
+// cost cap of a suggested guess (option -g), in scorings: a few ms on a Pi; in
+// spaces of more than HINT_BIG codes (5x8 and up) every partition walks a long
+// bitset, so they get a smaller cap
+#define HINT_BUDGET 20000
+#define HINT_BIG 8192
+#define HINT_BUDGET_BIG 5000
 
 // =======================================================
 
@@ -115,6 +148,12 @@
 #define DATA1_PIN 26
 #define DATA2_PIN 27
 #define DATA3_PIN 22
+// D0..D3 of the display, only wired for an 8-bit connection (option -8);
+// with 8 bits, DATA0_PIN..DATA3_PIN above are D4..D7
+#define DATA0_8BIT_PIN 4
+#define DATA1_8BIT_PIN 17
+#define DATA2_8BIT_PIN 18
+#define DATA3_8BIT_PIN 6
 
 /* ======================================================= */
 /* SECTION: constants and prototypes                       */
@@ -135,10 +174,32 @@ static unsigned char newChar[8] =
         0b11111,
 };
 
+// pegs of colours 1..10 (colour 0, no button press, is shown as newChar), and feedback markers
+static const unsigned char pegChars[MM_MAX_COLS][8] = {
+    {0b00000, 0b01110, 0b11111, 0b11111, 0b11111, 0b01110, 0b00000, 0b00000}, // filled circle
+    {0b00000, 0b01110, 0b10001, 0b10001, 0b10001, 0b01110, 0b00000, 0b00000}, // hollow circle
+    {0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b00000, 0b00000}, // filled square
+    {0b00000, 0b11111, 0b10001, 0b10001, 0b10001, 0b11111, 0b00000, 0b00000}, // hollow square
+    {0b00100, 0b01110, 0b11111, 0b11111, 0b01110, 0b00100, 0b00000, 0b00000}, // diamond
+    {0b00000, 0b00100, 0b01110, 0b01110, 0b11111, 0b11111, 0b00000, 0b00000}, // triangle
+    {0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000, 0b00000}, // plus
+    {0b00000, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b00000, 0b00000}, // cross
+    {0b00000, 0b01010, 0b11111, 0b11111, 0b01110, 0b00100, 0b00000, 0b00000}, // heart
+    {0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b00000}, // stripes
+};
+
+static const unsigned char exactChar[8] = {0b00000, 0b00000, 0b00000, 0b01110, 0b01110, 0b01110, 0b00000, 0b00000};
+static const unsigned char approxChar[8] = {0b00000, 0b00000, 0b00000, 0b01110, 0b01010, 0b01110, 0b00000, 0b00000};
+
+// glyph ids for the CGRAM cache: 0..MM_MAX_COLS are pegs, then the feedback markers
+#define GLYPH_EXACT (MM_MAX_COLS + 1)
+#define GLYPH_APPROX (MM_MAX_COLS + 2)
+
 /* Constants */
 
 static const int colors = COLS; // Store the number of colours in the sequence
 static const int seqlen = SEQL; // Store the length of the sequence
+static int distinct = 0;         // no colour twice in the secret or a guess, as in Bulls & Cows (-p)
 
 // Store the names of the colours, currently not used
 static char *color_names[] = {"red", "green", "blue"};
@@ -162,6 +223,20 @@ struct lcdDataStruct
 
 static int lcdControl;
 
+// which custom characters are in the CGRAM of the display
+static struct mmGlyphCache glyphs;
+
+// the display, emulated when running headless
+static struct mmLcdEmu lcdEmu;
+
+// a message scrolling through the display, by shifting the display window over DDRAM
+struct lcdMarquee
+{
+  int steps;      // shifts done so far
+  int stepMs;     // time between two shifts
+  uint64_t next;  // time of the next shift (mmNow())
+};
+
 /* ***************************************************************************** */
 /* INLINED fcts from wiringPi/devLib/lcd.c: */
 // HD44780U Commands (see Fig 11, p28 of the Hitachi HD44780U datasheet)
@@ -193,6 +268,11 @@ static int lcdControl;
 #define LCD_FUNC_DL 0x10
 
 #define LCD_CDSHIFT_RL 0x04
+#define LCD_CDSHIFT_SC 0x08 // shift the display, not the cursor
+
+// Each row of the display is a window onto a 40-character line of DDRAM
+
+#define LCD_DDRAM_COLS 40
 
 // Mask for the bottom 64 pins which belong to the Raspberry Pi
 //	The others are available for the other devices
@@ -204,12 +284,19 @@ static uint32_t *gpio;
 
 static int timed_out = 0;
 
+// opening book, mapped from the file given with -b
+static struct mmBook book;
+
+// random number generator for the secret; seeded with -r for reproducible games
+static struct mmRng rng;
+
 /* ------------------------------------------------------- */
 // misc prototypes
 
 int failure(int fatal, const char *message, ...);
 void waitForEnter(void);
 int waitForButton(uint32_t *gpio, int button);
+void delay(unsigned int howLong);
 
 /* ======================================================= */
 /* SECTION: hardware interface (LED, button, LCD display)  */
@@ -227,6 +314,10 @@ int waitForButton(uint32_t *gpio, int button);
  */
 void digitalWrite(uint32_t *gpio, int pin, int value)
 {
+  MM_COUNT_PIN(pin);
+  if (mmSim != NULL)
+    mmSimWrite(pin, value);
+#ifdef __arm__
   if (value == OFF)
   {
     asm volatile("mov r1, %[gpio]\n\t" // Move the GPIO base address into register r1
@@ -241,6 +332,10 @@ void digitalWrite(uint32_t *gpio, int pin, int value)
                  "str r2, [r1, #28]" // Store the value in r2 into the GPIO register at offset 28
                  : : [gpio] "r"(gpio), [value] "r"(1 << pin) : "r1", "r2");
   }
+#else
+  // the same stores in C where there is no ARM assembler, e.g. on a build host
+  ((volatile uint32_t *)gpio)[(value == OFF ? 40 : 28) / 4] = 1 << pin;
+#endif
 }
 
 /* set the @mode@ of a GPIO @pin@ to INPUT or OUTPUT; @gpio@ is the mmaped GPIO base address */
@@ -257,6 +352,7 @@ void pinMode(uint32_t *gpio, int pin, int mode)
   int register_offset = pin / 10;
   int bit_offset = (pin % 10) * 3;
 
+#ifdef __arm__
   asm volatile(
       "ldr r3, [%[gpio], %[offset]]\n\t" // Load current register value
       "mov r2, #1\n\t"
@@ -277,6 +373,12 @@ void pinMode(uint32_t *gpio, int pin, int mode)
       :
       : [gpio] "r"(gpio), [offset] "r"(register_offset * 4), [bit_offset] "r"(bit_offset), [mode] "m"(mode), [output] "i"(OUTPUT)
       : "r2", "r3", "r4", "cc", "memory");
+#else
+  if (mode == OUTPUT)
+    ((volatile uint32_t *)gpio)[register_offset] |= 1 << bit_offset;
+  else
+    ((volatile uint32_t *)gpio)[register_offset] &= ~(1 << bit_offset);
+#endif
 }
 
 /* send a @value@ (LOW or HIGH) on pin number @pin@; @gpio@ is the mmaped GPIO base address */
@@ -292,12 +394,16 @@ void pinMode(uint32_t *gpio, int pin, int mode)
 void writeLED(uint32_t *gpio, int led, int value) {
     int offset;
     
+    MM_COUNT_PIN(led);
+    if (mmSim != NULL)
+        mmSimWrite(led, value);
     if (value == ON) {
         offset = 28; // Offset for setting GPIO register
     } else { // value == OFF
         offset = 40; // Offset for clearing GPIO register
     }
-    
+
+#ifdef __arm__
     asm volatile (
         "mov r2, #1\n\t"
         "lsl r2, %[led]\n\t"
@@ -306,6 +412,9 @@ void writeLED(uint32_t *gpio, int led, int value) {
         : [gpio] "r" (gpio), [led] "r" (led), [offset] "r" (offset)
         : "r2", "memory"
     );
+#else
+    ((volatile uint32_t *)gpio)[offset / 4] = 1 << led;
+#endif
 }
 
 /* read a @value@ (OFF or ON) from pin number @pin@ (a button device); @gpio@ is the mmaped GPIO base address */
@@ -321,6 +430,11 @@ void writeLED(uint32_t *gpio, int led, int value) {
 int readButton(uint32_t *gpio, int pin)
 {
   int value;
+
+  MM_COUNT(buttonSamples);
+  if (mmSim != NULL)
+    mmSimSample(pin);
+#ifdef __arm__
   asm volatile(
       "ldr %[value], [%[gpio], #0x34]\n\t" // Load the value from the GPIO register into %[value]
       "mov r2, #1\n\t"                     // Move the value 1 into register r2
@@ -332,6 +446,9 @@ int readButton(uint32_t *gpio, int pin)
       : [value] "=&r"(value)
       : [gpio] "r"(gpio), [pin] "r"(pin)
       : "r2", "cc");
+#else
+  value = (((volatile uint32_t *)gpio)[0x34 / 4] >> pin) & 1;
+#endif
   return value;
 }
 
@@ -346,6 +463,9 @@ int readButton(uint32_t *gpio, int pin)
  *
  * @return 1 if the button is pressed, 0 otherwise.
  */
+// when the button was last seen released, 0 if unknown; a press came after that
+static uint64_t buttonReleasedAt;
+
 int waitForButton(uint32_t *gpio, int button)
 {
   // Loop until the button is pressed
@@ -357,7 +477,10 @@ int waitForButton(uint32_t *gpio, int button)
     // Check if the button is pressed
     if (state == ON)
     {
-      fprintf(stderr, "Button pressed\n");
+      MM_TRACE(MM_EV_BUTTON, button, 0);
+      if (buttonReleasedAt != 0)
+        MM_LATENCY(MM_LAT_PRESS, mmNow() - buttonReleasedAt);
+      buttonReleasedAt = 0; // held down: no new edge
       return 1;
       break;
     }
@@ -365,13 +488,12 @@ int waitForButton(uint32_t *gpio, int button)
     else
     {
       // state = ON;
-      struct timespec sleeper, dummy;
-      sleeper.tv_sec = 0;
-      sleeper.tv_nsec = 100000000;
-      nanosleep(&sleeper, &dummy);
+      buttonReleasedAt = mmNow();
+      mmSleep(100 * MM_NS_PER_MS);
       break;
     }
   }
+  return 0;
 }
 
 /* ======================================================= */
@@ -383,9 +505,6 @@ int waitForButton(uint32_t *gpio, int button)
 // Modified by Leressa
 void inititalizeSeq()
 {
-  // initializes the state of a random number generator with the current time, to ensure the sequence is always different
-  srand(time(NULL));
-
   // checks if the sequence has a memory allocation
   if (theSeq == NULL)
   {
@@ -397,11 +516,11 @@ void inititalizeSeq()
     }
   }
 
-  // inserting random values into the sequence
-  for (int i = 0; i < SEQL; i++)
-  {
-    theSeq[i] = rand() % 3 + 1; // generates a random number between 1 and 3
-  }
+  // a uniform random sequence with values between 1 and colors, from the generator seeded in main
+  if (distinct)
+    mmRngCodeDistinct(&rng, SEQL, colors, theSeq);
+  else
+    mmRngCode(&rng, SEQL, colors, theSeq);
 };
 
 /* display the sequence on the terminal window, using the format from the sample run in the spec */
@@ -417,6 +536,77 @@ void showSeq(int *seq)
   printf("\n");
 };
 
+/* check that all entries of @seq@ are valid colours */
+int seqInRange(int *seq)
+{
+  for (int i = 0; i < SEQL; i++)
+    if (seq[i] < 1 || seq[i] > COLS)
+      return FALSE;
+  return TRUE;
+}
+
+/* check that all entries of @seq@ are valid colours, and with -p that none repeats */
+int validSeq(int *seq)
+{
+  if (!seqInRange(seq))
+    return FALSE;
+  for (int i = 0; distinct && i < SEQL; i++)
+    for (int j = 0; j < i; j++)
+      if (seq[j] == seq[i])
+        return FALSE;
+  return TRUE;
+}
+
+/* show the sequence with index @code@ in @sp@, after @label@ */
+void showSeqCode(const struct mmSpace *sp, const char *label, mmCode code)
+{
+  unsigned char seq[MM_MAX_LEN];
+
+  mmDecode(sp, code, seq);
+  printf("%s", label);
+  for (int i = 0; i < sp->len; i++)
+    printf("%d ", seq[i]);
+  printf("\n");
+}
+
+/* show the guess suggested by the opening book at @node@ */
+void showBookGuess(const struct mmSpace *sp, uint32_t node)
+{
+  showSeqCode(sp, "Book suggests: ", mmBookGuess(&book, node));
+}
+
+/* check the opening book's @node@ as the game reaches it; a corrupt book is
+   closed, and the game goes on without it */
+int bookReached(uint32_t node)
+{
+  if (node != MM_BOOK_BAD && mmBookGuess(&book, node) != MM_BOOK_BAD)
+    return TRUE;
+  fprintf(stderr, "Opening book is corrupt (a node out of bounds); playing without it\n");
+  mmBookClose(&book);
+  return FALSE;
+}
+
+/* format the number of secrets still possible, and the suggested guess @hint@
+   unless it is sp->size, as one LCD row of at most @cols@ chars; the hint is
+   shortened, or left out, if it does not fit */
+void candidatesRow(char *buf, int cols, const struct mmSpace *sp, uint32_t count, mmCode hint)
+{
+  unsigned char seq[MM_MAX_LEN];
+  char pegs[MM_MAX_LEN + 1];
+  int n = sprintf(buf, "Left:%u", count);
+
+  if (hint >= sp->size)
+    return;
+  mmDecode(sp, hint, seq);
+  for (int i = 0; i < sp->len; i++)
+    pegs[i] = '0' + seq[i];
+  pegs[sp->len] = '\0';
+  if (n + 5 + sp->len <= cols)
+    sprintf(buf + n, " Try:%s", pegs);
+  else if (n + 1 + sp->len <= cols)
+    sprintf(buf + n, " %s", pegs);
+}
+
 // Not sure why this is used but we'll keep it for now
 #define NAN1 8
 #define NAN2 9
@@ -431,6 +621,8 @@ int /* or int* */ countMatches(int *seq1, int *seq2)
   // approximate is the count of correct entries in the wrong position
   int exact = 0, approximate = 0;
 
+  MM_COUNT(matchCalls);
+
   // // loops through seq1 and seq2 and shows both sequences
   // // Uncomment for debugging purposes
   // for (int j = 0; j < SEQL; j++)
@@ -475,7 +667,7 @@ void showMatches(int /* or int* */ code, /* only for debugging */ int *seq1, int
   int approximate = code & 0x0F;
 
   printf("%d exact\n", exact);
-  printf("%d approximate", approximate);
+  printf("%d approximate\n", approximate);
 }
 
 /* parse an integer value as a list of digits, and put them into @seq@ */
@@ -497,13 +689,62 @@ void readSeq(int *seq, int val)
 int readNum(int max)
 {
   int num;
-  // read a number from stdin
+  // read a number from stdin; several may be typed on one line
   printf("Enter a number between 0 and %d: ", max);
-  scanf("%d", &num);
+  fflush(stdout);
+  if (scanf("%d", &num) != 1)
+    return -1; // end of input, or not a number
 
   return num;
 }
 
+/* ======================================================= */
+/* SECTION: input sources                                  */
+/* ------------------------------------------------------- */
+/* the button and stdin sources of pegs; scripts are in mm-input.c */
+
+/* count the button presses within one input window, at most COLS */
+int buttonPeg(struct mmInput *in, int peg)
+{
+  uint64_t endTime = mmNow() + WINDOW * MM_NS_PER_MS;
+  int buttonPressCount = 0;
+
+  (void)in;
+  (void)peg;
+  buttonReleasedAt = 0; // a press from before the window has no known edge
+  if (mmSim != NULL)
+    mmSimInput();
+  while (mmNow() < endTime)
+  {
+    // Wait for the button to be pressed
+    if (waitForButton(gpio, BUTTON) == 1)
+    {
+      buttonPressCount++;
+      delay(MM_INPUT_LOCKOUT_MS);
+    }
+    if (buttonPressCount >= COLS)
+    {
+      buttonPressCount = COLS;
+      break;
+    }
+  }
+  return buttonPressCount;
+}
+
+/* a number typed on stdin */
+int stdinPeg(struct mmInput *in, int peg)
+{
+  (void)in;
+  (void)peg;
+  return readNum(COLS);
+}
+
+static struct mmInput buttonInput = {"button", buttonPeg}, stdinInput = {"stdin", stdinPeg};
+
+// the keypad needs the GPIOs, so it is only set up once they are mapped
+static struct mmInput keypadInput;
+static struct mmKeypad keypad;
+
 /* ======================================================= */
 /* SECTION: TIMER code                                     */
 /* ------------------------------------------------------- */
@@ -607,22 +848,14 @@ void waitForEnter(void)
 
 void delay(unsigned int howLong)
 {
-  struct timespec sleeper, dummy;
-
-  // Set the time to sleep based on howLong input
-  sleeper.tv_sec = (time_t)(howLong / 1000);
-  sleeper.tv_nsec = (long)(howLong % 1000) * 1000000;
-
-  // Sleep for the specified time
-  nanosleep(&sleeper, &dummy);
+  // Sleep for the specified time, on the real or the virtual clock
+  MM_SLEEP_BEGIN();
+  mmSleep(howLong * MM_NS_PER_MS);
+  MM_SLEEP_END(howLong * MM_NS_PER_MS);
 }
 
 void delayMicroseconds(unsigned int howLong)
 {
-  struct timespec sleeper;
-  unsigned int uSecs = howLong % 1000000;
-  unsigned int wSecs = howLong / 1000000;
-
   /**/ if (howLong == 0)
     return;
 #if 0
@@ -631,9 +864,9 @@ void delayMicroseconds(unsigned int howLong)
 #endif
   else
   {
-    sleeper.tv_sec = wSecs;
-    sleeper.tv_nsec = (long)(uSecs * 1000L);
-    nanosleep(&sleeper, NULL);
+    MM_SLEEP_BEGIN();
+    mmSleep(howLong * 1000ULL);
+    MM_SLEEP_END(howLong * 1000ULL);
   }
 }
 
@@ -651,6 +884,7 @@ void delayMicroseconds(unsigned int howLong)
 
 void strobe(const struct lcdDataStruct *lcd)
 {
+  MM_COUNT(strobes);
 
   // Note timing changes for new version of delayMicroseconds ()
   digitalWrite(gpio, lcd->strbPin, 1);
@@ -706,9 +940,8 @@ void sendDataCmd(const struct lcdDataStruct *lcd, unsigned char data)
 
 void lcdPutCommand(const struct lcdDataStruct *lcd, unsigned char command)
 {
-#ifdef DEBUG
-  fprintf(stderr, "lcdPutCommand: digitalWrite(%d,%d) and sendDataCmd(%d,%d)\n", lcd->rsPin, 0, lcd, command);
-#endif
+  MM_TRACE(MM_EV_LCD_CMD, command, 0);
+  MM_COUNT(lcdCommands);
   digitalWrite(gpio, lcd->rsPin, 0);
   sendDataCmd(lcd, command);
   delay(2);
@@ -719,6 +952,7 @@ void lcdPut4Command(const struct lcdDataStruct *lcd, unsigned char command)
   register unsigned char myCommand = command;
   register unsigned char i;
 
+  MM_COUNT(lcdCommands);
   digitalWrite(gpio, lcd->rsPin, 0);
 
   for (i = 0; i < 4; ++i)
@@ -737,9 +971,7 @@ void lcdPut4Command(const struct lcdDataStruct *lcd, unsigned char command)
 
 void lcdHome(struct lcdDataStruct *lcd)
 {
-#ifdef DEBUG
-  fprintf(stderr, "lcdHome: lcdPutCommand(%d,%d)\n", lcd, LCD_HOME);
-#endif
+  MM_TRACE(MM_EV_LCD_HOME, 0, 0);
   lcdPutCommand(lcd, LCD_HOME);
   lcd->cx = lcd->cy = 0;
   delay(5);
@@ -747,13 +979,14 @@ void lcdHome(struct lcdDataStruct *lcd)
 
 void lcdClear(struct lcdDataStruct *lcd)
 {
-#ifdef DEBUG
-  fprintf(stderr, "lcdClear: lcdPutCommand(%d,%d) and lcdPutCommand(%d,%d)\n", lcd, LCD_CLEAR, lcd, LCD_HOME);
-#endif
+  MM_TRACE(MM_EV_LCD_CLEAR, 0, 0);
+  MM_PHASE_BEGIN(MM_PHASE_LCD);
   lcdPutCommand(lcd, LCD_CLEAR);
   lcdPutCommand(lcd, LCD_HOME);
   lcd->cx = lcd->cy = 0;
+  mmGlyphFrame(&glyphs); // nothing on screen uses a custom character any more
   delay(5);
+  MM_PHASE_END(MM_PHASE_LCD);
 }
 
 /*
@@ -823,6 +1056,7 @@ void lcdCursorBlink(struct lcdDataStruct *lcd, int state)
 
 void lcdPutchar(struct lcdDataStruct *lcd, unsigned char data)
 {
+  MM_COUNT(lcdData);
   digitalWrite(gpio, lcd->rsPin, 1);
   sendDataCmd(lcd, data);
 
@@ -845,8 +1079,393 @@ void lcdPutchar(struct lcdDataStruct *lcd, unsigned char data)
 
 void lcdPuts(struct lcdDataStruct *lcd, const char *string)
 {
+  MM_TRACE(MM_EV_LCD_PUTS, lcd->cx, strlen(string));
+  MM_PHASE_BEGIN(MM_PHASE_LCD);
   while (*string)
     lcdPutchar(lcd, *string++);
+  MM_PHASE_END(MM_PHASE_LCD);
+}
+
+/*
+ * lcdDefineChar:
+ *	Upload the 5x8 @bitmap@ of a custom character into CGRAM slot @slot@ (0..7),
+ *	then go back to the cursor position in DDRAM.
+ *********************************************************************************
+ */
+
+void lcdDefineChar(struct lcdDataStruct *lcd, int slot, const unsigned char *bitmap)
+{
+  MM_TRACE(MM_EV_LCD_GLYPH, slot, 0);
+  lcdPutCommand(lcd, LCD_CGRAM | (slot << 3));
+  digitalWrite(gpio, lcd->rsPin, 1);
+  for (int i = 0; i < 8; i++)
+  {
+    MM_COUNT(lcdData);
+    sendDataCmd(lcd, bitmap[i]);
+  }
+  lcdPosition(lcd, lcd->cx, lcd->cy);
+}
+
+/*
+ * lcdPutGlyph:
+ *	Show glyph @id@ at the cursor, uploading it only if it is not in CGRAM yet;
+ *	shows @fallback@ if all CGRAM slots are taken on the current screen.
+ *********************************************************************************
+ */
+
+void lcdPutGlyph(struct lcdDataStruct *lcd, int id, unsigned char fallback)
+{
+  int upload, slot = mmGlyphSlot(&glyphs, id, &upload);
+
+  if (slot < 0)
+  {
+    lcdPutchar(lcd, fallback);
+    return;
+  }
+  if (upload)
+    lcdDefineChar(lcd, slot, id == GLYPH_EXACT ? exactChar : id == GLYPH_APPROX ? approxChar : id == 0 ? newChar : pegChars[id - 1]);
+  lcdPutchar(lcd, slot);
+}
+
+/*
+ * lcdShowGuess:
+ *	Show a guess as colour pegs, followed by its feedback as markers, on one row,
+ *	e.g. for 3 pegs and 1 exact, 1 approximate match: "ABC XY" with glyphs.
+ *********************************************************************************
+ */
+
+void lcdShowGuess(struct lcdDataStruct *lcd, int row, const int *seq, int code)
+{
+  int exact = code >> 4, approximate = code & 0xF;
+
+  MM_PHASE_BEGIN(MM_PHASE_LCD);
+  lcdPosition(lcd, 0, row);
+  for (int i = 0; i < seqlen; i++)
+    lcdPutGlyph(lcd, seq[i] >= 0 && seq[i] <= colors ? seq[i] : 0, '0' + seq[i]);
+  lcdPutchar(lcd, ' ');
+  for (int i = 0; i < exact && seqlen + 1 + i < lcd->cols; i++)
+    lcdPutGlyph(lcd, GLYPH_EXACT, '*');
+  for (int i = 0; i < approximate && seqlen + 1 + exact + i < lcd->cols; i++)
+    lcdPutGlyph(lcd, GLYPH_APPROX, '+');
+  MM_PHASE_END(MM_PHASE_LCD);
+}
+
+/*
+ * lcdMarqueeStart: lcdMarqueeTick: lcdMarqueeStop:
+ *	Scroll a message of up to 40 characters through row @row@. The text is written
+ *	into the DDRAM line of that row once; after that, each step is a single
+ *	display-shift command, so lcdMarqueeTick can be called from any polling loop
+ *	and costs nothing until a step is due. The display shifts both rows alike.
+ *********************************************************************************
+ */
+
+void lcdMarqueeStart(struct lcdDataStruct *lcd, struct lcdMarquee *mq, int row, const char *text, int stepMs)
+{
+  int n = strlen(text);
+
+  MM_TRACE(MM_EV_LCD_PUTS, 0, n);
+  lcdPutCommand(lcd, LCD_HOME); // also undoes any earlier display shift
+  lcdPutCommand(lcd, LCD_DGRAM | (row > 0 ? 0x40 : 0x00));
+  digitalWrite(gpio, lcd->rsPin, 1);
+  // pad the whole line, so that the text comes round again after 40 shifts
+  for (int i = 0; i < LCD_DDRAM_COLS; i++)
+  {
+    MM_COUNT(lcdData);
+    sendDataCmd(lcd, i < n ? text[i] : ' ');
+  }
+  lcdPosition(lcd, lcd->cx, lcd->cy);
+
+  mq->steps = 0;
+  mq->stepMs = stepMs;
+  mq->next = mmNow() + stepMs * MM_NS_PER_MS;
+}
+
+/* shift the display by one column if the next step is due; returns 1 if it did */
+int lcdMarqueeTick(struct lcdDataStruct *lcd, struct lcdMarquee *mq)
+{
+  if (mmNow() < mq->next)
+    return 0;
+  lcdPutCommand(lcd, LCD_CDSHIFT | LCD_CDSHIFT_SC); // display shift to the left
+  mq->steps++;
+  mq->next += mq->stepMs * MM_NS_PER_MS;
+  return 1;
+}
+
+void lcdMarqueeStop(struct lcdDataStruct *lcd, struct lcdMarquee *mq)
+{
+  lcdPutCommand(lcd, LCD_HOME);
+  lcd->cx = lcd->cy = 0;
+  mq->steps = 0;
+}
+
+/* show @text@ on row @row@, scrolling it once all the way round if it does not fit */
+void lcdScroll(struct lcdDataStruct *lcd, int row, const char *text, int stepMs)
+{
+  struct lcdMarquee mq;
+
+  if ((int)strlen(text) <= lcd->cols)
+  {
+    lcdPosition(lcd, 0, row);
+    lcdPuts(lcd, text);
+    return;
+  }
+  lcdMarqueeStart(lcd, &mq, row, text, stepMs);
+  while (mq.steps < LCD_DDRAM_COLS)
+  {
+    uint64_t now = mmNow();
+
+    if (mq.next > now)
+      mmSleep(mq.next - now);
+    lcdMarqueeTick(lcd, &mq);
+  }
+  lcdMarqueeStop(lcd, &mq);
+}
+
+/*
+ * lcdInit:
+ *	Set up the display on the hard-wired pins, with a 4-bit or an 8-bit connection.
+ *	Based on the inlined version of lcdInit from wiringPi (only one LCD attached to the RPi).
+ *********************************************************************************
+ */
+
+struct lcdDataStruct *lcdInit(int rows, int cols, int bits)
+{
+  static const int lowPins[4] = {DATA0_8BIT_PIN, DATA1_8BIT_PIN, DATA2_8BIT_PIN, DATA3_8BIT_PIN};
+  static const int highPins[4] = {DATA0_PIN, DATA1_PIN, DATA2_PIN, DATA3_PIN};
+  struct lcdDataStruct *lcd;
+  unsigned char func;
+  int i;
+
+  // Create a new LCD:
+  lcd = (struct lcdDataStruct *)malloc(sizeof(struct lcdDataStruct));
+  if (lcd == NULL)
+    return NULL;
+
+  // hard-wired GPIO pins
+  lcd->rsPin = RS_PIN;
+  lcd->strbPin = STRB_PIN;
+  lcd->bits = bits;
+  lcd->rows = rows; // # of rows on the display
+  lcd->cols = cols; // # of cols on the display
+  lcd->cx = 0;      // x-pos of cursor
+  lcd->cy = 0;      // y-pos of curosr
+
+  // dataPins[i] carries bit i of what sendDataCmd writes; with 4 bits, that is D4..D7
+  for (i = 0; i < 4; ++i)
+  {
+    lcd->dataPins[i] = bits == 8 ? lowPins[i] : highPins[i];
+    lcd->dataPins[i + 4] = highPins[i];
+  }
+
+  digitalWrite(gpio, lcd->rsPin, 0);
+  pinMode(gpio, lcd->rsPin, OUTPUT);
+  digitalWrite(gpio, lcd->strbPin, 0);
+  pinMode(gpio, lcd->strbPin, OUTPUT);
+
+  for (i = 0; i < bits; ++i)
+  {
+    digitalWrite(gpio, lcd->dataPins[i], 0);
+    pinMode(gpio, lcd->dataPins[i], OUTPUT);
+  }
+  delay(35); // mS
+
+  // Gordon Henderson's explanation of this part of the init code (from wiringPi):
+  // 4-bit mode?
+  //	OK. This is a PIG and it's not at all obvious from the documentation I had,
+  //	so I guess some others have worked through either with better documentation
+  //	or more trial and error... Anyway here goes:
+  //
+  //	It seems that the controller needs to see the FUNC command at least 3 times
+  //	consecutively - in 8-bit mode. If you're only using 8-bit mode, then it appears
+  //	that you can get away with one func-set, however I'd not rely on it...
+  //
+  //	So to set 4-bit mode, you need to send the commands one nibble at a time,
+  //	the same three times, but send the command to set it into 8-bit mode those
+  //	three times, then send a final 4th command to set it into 4-bit mode, and only
+  //	then can you flip the switch for the rest of the library to work in 4-bit
+  //	mode which sends the commands as 2 x 4-bit values.
+
+  // Cool explainantion Mr. Henderson!
+
+  if (bits == 4)
+  {
+    func = LCD_FUNC | LCD_FUNC_DL; // Set 8-bit mode 3 times
+    lcdPut4Command(lcd, func >> 4);
+    delay(35);
+    lcdPut4Command(lcd, func >> 4);
+    delay(35);
+    lcdPut4Command(lcd, func >> 4);
+    delay(35);
+    func = LCD_FUNC; // 4th set: 4-bit mode
+    lcdPut4Command(lcd, func >> 4);
+    delay(35);
+  }
+  else
+  {
+    // 8-bit mode: the same reset sequence, with whole bytes; every byte is one strobe from now on
+    func = LCD_FUNC | LCD_FUNC_DL;
+    lcdPutCommand(lcd, func);
+    delay(35);
+    lcdPutCommand(lcd, func);
+    delay(35);
+    lcdPutCommand(lcd, func);
+    delay(35);
+  }
+
+  if (lcd->rows > 1)
+  {
+    func |= LCD_FUNC_N;
+    lcdPutCommand(lcd, func);
+    delay(35);
+  }
+
+  // Rest of the initialisation sequence
+  lcdDisplay(lcd, TRUE);
+  lcdCursor(lcd, FALSE);
+  lcdCursorBlink(lcd, FALSE);
+  lcdClear(lcd);
+
+  lcdPutCommand(lcd, LCD_ENTRY | LCD_ENTRY_ID);     // set entry mode to increment address counter after write
+  lcdPutCommand(lcd, LCD_CDSHIFT | LCD_CDSHIFT_RL); // set display shift to right-to-left
+  mmGlyphInit(&glyphs);                             // CGRAM content is undefined after power-up
+
+  return lcd;
+}
+
+/*
+ * lcdBenchmark:
+ *	Measure characters per second with a 4-bit and, if the display is wired for it
+ *	(@bits@ is 8), an 8-bit connection; the display is left in the mode given by @bits@.
+ *********************************************************************************
+ */
+
+struct lcdDataStruct *lcdBenchmark(struct lcdDataStruct *lcd, int bits)
+{
+  int modes[2] = {4, 8}, n = lcd->rows * lcd->cols * 8;
+
+  for (int m = 0; m < 2 && modes[m] <= bits; m++)
+  {
+    struct lcdDataStruct *l = lcdInit(lcd->rows, lcd->cols, modes[m]);
+    uint64_t t0;
+
+    if (l == NULL)
+      return lcd;
+    free(lcd);
+    lcd = l;
+    t0 = mmNow();
+    for (int i = 0; i < n; i++)
+      lcdPutchar(lcd, 'A' + i % 26);
+    t0 = mmNow() - t0;
+    fprintf(stdout, "LCD %d-bit: %d chars in %.1f ms, %.0f chars/s\n", modes[m], n, t0 / 1e6,
+            n / ((double)t0 / MM_NS_PER_SEC));
+  }
+  return lcd;
+}
+
+/*
+ * ioBenchmark:
+ *	Cost of the GPIO and LCD paths against the in-memory register block of the
+ *	headless mode, so that runs on a build host and on the Pi can be compared:
+ *	wall-clock time per GPIO write and read, the game's functions (inline asm on
+ *	the Pi) against plain C accesses, then per bus transfer (a nibble, or a byte
+ *	over 8 bits), character and full-screen redraw, with the pin writes and E
+ *	cycles each takes. The LCD delays only advance the virtual clock, so the
+ *	LCD rates are also given paced by them, as the display would get them.
+ *********************************************************************************
+ */
+
+#ifdef __arm__
+#define IO_IMPL "inline asm"
+#else
+#define IO_IMPL "C fallback"
+#endif
+
+static void ioReport(const char *what, uint64_t n, uint64_t wallNs, uint64_t virtNs, uint64_t writes, uint64_t strobes)
+{
+  fprintf(stdout, "%-24s %9.1f ns %12.0f/s", what, (double)wallNs / n, n / ((double)wallNs / MM_NS_PER_SEC));
+  if (virtNs > 0)
+    fprintf(stdout, "   paced %9.1f us %8.0f/s", (double)virtNs / n / 1e3, n / ((double)virtNs / MM_NS_PER_SEC));
+  if (writes > 0)
+    fprintf(stdout, "   %5.1f writes %4.1f E", (double)writes / n, (double)strobes / n);
+  fprintf(stdout, "\n");
+}
+
+int ioBenchmark(struct lcdDataStruct *lcd)
+{
+  struct mmSim *sim = mmSim;
+  volatile uint32_t *regs = gpio;
+  char text[MM_LCD_DDRAM + 1], row[MM_LCD_DDRAM + 1];
+  int n = lcd->rows * lcd->cols, ok = 1;
+  uint64_t t0, v0, w0, e0;
+
+  for (int i = 0; i < n; i++)
+    text[i] = 'A' + i % 26;
+  text[n] = '\0';
+  fprintf(stdout, "GPIO/LCD benchmark against the in-memory register block, GPIO access by %s\n", IO_IMPL);
+  fprintf(stdout, "%-24s %12s %14s   %-26s   %s\n", "", "CPU/op", "CPU rate", "paced/op, rate", "bus/op");
+
+  // single accesses, without the simulation behind them
+  mmSim = NULL;
+  t0 = mmClockReal.now();
+  for (int i = 0; i < IO_BENCH_LOOPS; i++)
+    digitalWrite(gpio, GREEN_LED, i & 1);
+  ioReport("digitalWrite", IO_BENCH_LOOPS, mmClockReal.now() - t0, 0, 0, 0);
+  t0 = mmClockReal.now();
+  for (int i = 0; i < IO_BENCH_LOOPS; i++)
+    writeLED(gpio, GREEN_LED, i & 1);
+  ioReport("writeLED", IO_BENCH_LOOPS, mmClockReal.now() - t0, 0, 0, 0);
+  t0 = mmClockReal.now();
+  for (int i = 0; i < IO_BENCH_LOOPS; i++)
+    regs[i & 1 ? 7 : 10] = 1 << GREEN_LED; // GPSET0/GPCLR0
+  ioReport("C store", IO_BENCH_LOOPS, mmClockReal.now() - t0, 0, 0, 0);
+  t0 = mmClockReal.now();
+  for (int i = 0; i < IO_BENCH_LOOPS; i++)
+    readButton(gpio, BUTTON);
+  ioReport("readButton", IO_BENCH_LOOPS, mmClockReal.now() - t0, 0, 0, 0);
+  t0 = mmClockReal.now();
+  for (int i = 0; i < IO_BENCH_LOOPS; i++)
+    (void)((regs[MM_SIM_GPLEV0] >> BUTTON) & 1);
+  ioReport("C load", IO_BENCH_LOOPS, mmClockReal.now() - t0, 0, 0, 0);
+  mmSim = sim;
+
+  // one redraw as the emulated display decodes it, then the LCD paths without the emulator
+  lcdClear(lcd);
+  lcdPuts(lcd, text);
+  for (int r = 0; r < lcd->rows; r++)
+  {
+    mmLcdEmuRow(sim->lcd, r, lcd->cols, row);
+    ok = ok && strncmp(row, text + r * lcd->cols, lcd->cols) == 0;
+  }
+  if (!ok || mmLcdEmuViolations(sim->lcd) != 0)
+  {
+    mmLcdEmuReport(stderr, sim->lcd, lcd->cols);
+    fprintf(stderr, "benchmark: the emulated display did not get the redraw right\n");
+    return -1;
+  }
+  sim->lcd = NULL;
+
+  digitalWrite(gpio, lcd->rsPin, 1);
+  t0 = mmClockReal.now(), v0 = mmNow(), w0 = sim->writes, e0 = sim->rises[lcd->strbPin];
+  for (int i = 0; i < IO_BENCH_CHARS; i++)
+    sendDataCmd(lcd, text[i % n]);
+  ioReport(lcd->bits == 4 ? "nibble" : "byte (8-bit bus)", IO_BENCH_CHARS * (lcd->bits == 4 ? 2 : 1),
+           mmClockReal.now() - t0, mmNow() - v0, sim->writes - w0, sim->rises[lcd->strbPin] - e0);
+
+  t0 = mmClockReal.now(), v0 = mmNow(), w0 = sim->writes, e0 = sim->rises[lcd->strbPin];
+  for (int i = 0; i < IO_BENCH_CHARS; i++)
+    lcdPutchar(lcd, text[i % n]);
+  ioReport("character", IO_BENCH_CHARS, mmClockReal.now() - t0, mmNow() - v0, sim->writes - w0,
+           sim->rises[lcd->strbPin] - e0);
+
+  t0 = mmClockReal.now(), v0 = mmNow(), w0 = sim->writes, e0 = sim->rises[lcd->strbPin];
+  for (int i = 0; i < IO_BENCH_REDRAWS; i++)
+  {
+    lcdClear(lcd);
+    lcdPuts(lcd, text);
+  }
+  ioReport("full-screen redraw", IO_BENCH_REDRAWS, mmClockReal.now() - t0, mmNow() - v0, sim->writes - w0,
+           sim->rises[lcd->strbPin] - e0);
+  return 0;
 }
 
 /* ======================================================= */
@@ -888,25 +1507,69 @@ int main(int argc, char *argv[])
   int fd;
 
   int exact, approximate;
+
+  // the previous guess and its feedback, shown while entering the next one
+  int lastGuess[MM_MAX_LEN], lastCode = -1;
   char str1[32];
   char str2[32];
 
   struct timeval t1, t2;
   int t;
 
-  char buf[32];
+  // when the last peg was entered and the guess matched, for the latency histograms
+  uint64_t lastPegAt = 0, matchedAt = 0;
+
+  // binary log of the game (option -l); records are only buffered while playing
+  struct mmLog gameLog;
+  struct mmLogRecord rec;
+  int logging = 0, presses = 0;
+  uint64_t gameStart = 0, roundStart = 0;
+
+  // where the pegs of a guess come from (option -i)
+  struct mmInput *input = &buttonInput, scriptInput;
+  char *opt_i = NULL;
+  int endOfInput = FALSE;
+  uint64_t keypadScanNs = MM_KEYPAD_SCAN_NS;
+
+  char buf[48];
 
   // variables for command-line processing
   char str_in[20], str[20] = "some text";
   int verbose = 0, debug = 0, help = 0, opt_m = 0, opt_n = 0, opt_s = 0, unit_test = 0, res_matches = 0;
+  char *opt_b = NULL, *opt_T = NULL, *opt_H = NULL, *opt_l = NULL;
+  uint64_t opt_r = 0;
+  int seeded = 0, selftest = 0, opt_8 = 0, lcdBench = 0, ioBench = 0, opt_rt = 0, jitter = 0;
+  struct mmRtConfig rt = {-1, MM_RT_PRIORITY, MM_RT_STACK};
+
+  // code space of the game, and position in the opening book (if any)
+  struct mmSpace space;
+  uint32_t bookNode = 0;
+  mmCode guess, hint;
+
+  // feedback so far while the player follows the compiled-in strategy (mm-gentree.h), or -1
+  unsigned char genScores[16];
+  int genDepth;
+
+  // secrets consistent with the feedback so far, narrowed down each round
+  struct mmCandidates cands;
+  struct mmIndex candIndex;
+  struct mmSymmetry sym;
+  int opt_g = 0;
 
   // -------------------------------------------------------
   // process command-line arguments
 
   // see: man 3 getopt for docu and an example of command line parsing
   { // see the CW spec for the intended meaning of these options
+    static const struct option longOpts[] = {
+        {"selftest", no_argument, NULL, 'S'},
+        {"rt", optional_argument, NULL, 'R'},
+        {"jitter", no_argument, NULL, 'J'},
+        {"lcd-bench", no_argument, NULL, 'L'},
+        {"io-bench", no_argument, NULL, 'I'},
+        {NULL, 0, NULL, 0}};
     int opt;
-    while ((opt = getopt(argc, argv, "hvdus:")) != -1)
+    while ((opt = getopt_long(argc, argv, "hvdugp8s:b:r:T:H:l:i:", longOpts, NULL)) != -1)
     {
       switch (opt)
       {
@@ -925,8 +1588,53 @@ int main(int argc, char *argv[])
       case 's':
         opt_s = atoi(optarg);
         break;
+      case 'b':
+        opt_b = optarg;
+        break;
+      case 'g':
+        opt_g = 1;
+        break;
+      case 'p':
+        distinct = 1;
+        break;
+      case '8':
+        opt_8 = 1;
+        break;
+      case 'L':
+        lcdBench = 1;
+        break;
+      case 'I':
+        ioBench = 1;
+        break;
+      case 'S':
+        selftest = 1;
+        break;
+      case 'R':
+        opt_rt = 1;
+        if (optarg)
+          rt.cpu = atoi(optarg);
+        break;
+      case 'J':
+        jitter = 1;
+        break;
+      case 'H':
+        opt_H = optarg;
+        break;
+      case 'T':
+        opt_T = optarg;
+        break;
+      case 'l':
+        opt_l = optarg;
+        break;
+      case 'i':
+        opt_i = optarg;
+        break;
+      case 'r':
+        opt_r = strtoull(optarg, NULL, 0);
+        seeded = 1;
+        break;
       default: /* '?' */
-        fprintf(stderr, "Usage: %s [-h] [-v] [-d] [-u <seq1> <seq2>] [-s <secret seq>]  \n", argv[0]);
+        fprintf(stderr, "Usage: %s [-h] [-v] [-d] [-g] [-p] [-8] [-u <seq1> <seq2>] [-s <secret seq>] [-r <seed>] [-b <book>] [-T <trace file>] [-l <game log>] [-i button|stdin|keypad[:<scan us>]|<script>] [-H <presses>] [--selftest] [--lcd-bench] [--io-bench] [--rt[=<cpu>]] [--jitter]  \n", argv[0]);
         exit(EXIT_FAILURE);
       }
     }
@@ -937,7 +1645,7 @@ int main(int argc, char *argv[])
     fprintf(stderr, "MasterMind program, running on a Raspberry Pi, with connected LED, button and LCD display\n");
     fprintf(stderr, "Use the button for input of numbers. The LCD display will show the matches with the secret sequence.\n");
     fprintf(stderr, "For full specification of the program see: https://www.macs.hw.ac.uk/~hwloidl/Courses/F28HS/F28HS_CW2_2022.pdf\n");
-    fprintf(stderr, "Usage: %s [-h] [-v] [-d] [-u <seq1> <seq2>] [-s <secret seq>]  \n", argv[0]);
+    fprintf(stderr, "Usage: %s [-h] [-v] [-d] [-g] [-p] [-8] [-u <seq1> <seq2>] [-s <secret seq>] [-r <seed>] [-b <book>] [-T <trace file>] [-l <game log>] [-i button|stdin|keypad[:<scan us>]|<script>] [-H <presses>] [--selftest] [--lcd-bench] [--io-bench] [--rt[=<cpu>]] [--jitter]  \n", argv[0]);
     exit(EXIT_SUCCESS);
   }
 
@@ -961,7 +1669,65 @@ int main(int argc, char *argv[])
     fprintf(stdout, "Unittest is %s\n", (unit_test ? "ON" : "OFF"));
     if (opt_s)
       fprintf(stdout, "Secret sequence set to %d\n", opt_s);
+    if (opt_b)
+      fprintf(stdout, "Opening book is %s\n", opt_b);
+    if (opt_T)
+      fprintf(stdout, "Trace file is %s\n", opt_T);
+    if (opt_l)
+      fprintf(stdout, "Game log is %s\n", opt_l);
+    if (opt_i)
+      fprintf(stdout, "Input from %s\n", opt_i);
+    if (opt_H)
+      fprintf(stdout, "Running headless, with button presses %s\n", opt_H);
+    if (distinct)
+      fprintf(stdout, "No colour may repeat in the secret or a guess\n");
+  }
+
+  // a different secret every game, unless a seed is given to replay one
+  if (!seeded)
+    opt_r = ((uint64_t)time(NULL) << 16) ^ getpid();
+  mmRngSeed(&rng, opt_r);
+  MM_STATS_INIT();
+  mmTraceInit(opt_T);
+  if (verbose || debug)
+    fprintf(stdout, "Random seed is %llu (replay with -r)\n", (unsigned long long)opt_r);
+
+  // without repeats, the space only has the codes whose colours all differ, scored in packed form
+  if ((distinct ? mmSpaceInitDistinct : mmSpaceInit)(&space, seqlen, colors) < 0)
+  {
+    fprintf(stderr, "No game of %d pegs in %d colours%s\n", seqlen, colors, distinct ? " without repeats" : "");
+    exit(EXIT_FAILURE);
+  }
+  if (distinct && mmSpacePack(&space, MM_PACK_MAX_BYTES) < 0 && debug)
+    fprintf(stderr, "Code space too big for a packed table, decoding codes instead\n");
+  if (opt_b)
+  { // map the opening book; it is only used if it was built for this configuration
+    if (mmBookOpen(&book, opt_b) < 0)
+      fprintf(stderr, "Cannot read opening book %s, playing without it\n", opt_b);
+    else if (book.hdr->len != seqlen || book.hdr->colors != colors || !(book.hdr->flags & MM_BOOK_DISTINCT) != !distinct)
+    {
+      fprintf(stderr, "Opening book %s is for %dx%d%s, not %dx%d%s; playing without it\n", opt_b, book.hdr->len, book.hdr->colors,
+              book.hdr->flags & MM_BOOK_DISTINCT ? " without repeats" : "", seqlen, colors, distinct ? " without repeats" : "");
+      mmBookClose(&book);
+    }
   }
+  // the strategy compiled in with make GEN=1, unless there is a book
+  genDepth = book.hdr == NULL && mmGenLen == seqlen && mmGenColors == colors && !mmGenDistinct == !distinct ? 0 : -1;
+  if (mmGenLen != 0 && book.hdr == NULL && genDepth < 0)
+    fprintf(stderr, "Compiled-in strategy is for %dx%d%s, not %dx%d%s; playing without it\n", mmGenLen, mmGenColors,
+            mmGenDistinct ? " without repeats" : "", seqlen, colors, distinct ? " without repeats" : "");
+  else if (genDepth == 0 && verbose)
+    fprintf(stdout, "Using the compiled-in strategy for %dx%d\n", mmGenLen, mmGenColors);
+  // no mask table: building one costs more than the few filter steps of a game save;
+  // the inverted index is small and built in one pass (if not, every candidate is scored)
+  mmIndexBuild(&candIndex, &space, MM_INDEX_MAX_BYTES);
+  if (mmCandInit(&cands, &space, NULL, &candIndex) < 0)
+  {
+    fprintf(stderr, "Out of memory for the candidate set\n");
+    exit(EXIT_FAILURE);
+  }
+  mmSymInit(&sym, &space);
+  hint = space.size;
 
   seq1 = (int *)malloc(seqlen * sizeof(int));
   seq2 = (int *)malloc(seqlen * sizeof(int));
@@ -989,11 +1755,45 @@ int main(int argc, char *argv[])
     /* nothing to do here; just continue with the rest of the main fct */
   }
 
+  // check countMatches against known vectors, the reference scoring and its properties, in-process
+  if (selftest)
+  {
+    struct mmSelfTestResult res;
+    int ret = mmSelfTest(countMatches, &space, seeded ? opt_r : 1701, stderr, &res);
+
+    fprintf(stdout, "selftest %dx%d: %llu passed, %llu failed (%.3f ms)\n", seqlen, colors,
+            (unsigned long long)res.passed, (unsigned long long)res.failed, res.us / 1000.0);
+    exit(ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  // wakeup latency with the default scheduler, then in real-time mode (needs root)
+  if (jitter)
+  {
+    for (int mode = 0; mode < 2; mode++)
+    {
+      struct mmHist h;
+
+      if (mode == 1 && mmRtEnter(&rt, stderr) < 0)
+        fprintf(stderr, "Real-time mode only partly in effect\n");
+      memset(&h, 0, sizeof(h));
+      mmRtJitter(&h, JITTER_LOOPS, MM_NS_PER_MS);
+      fprintf(stdout, "jitter %s: %llu wakeups, late by p50 %.1f us, p99 %.1f us, max %.1f us\n",
+              mode ? "real-time" : "default  ", (unsigned long long)h.count, mmHistPercentile(&h, 500) / 1e3,
+              mmHistPercentile(&h, 990) / 1e3, h.max / 1e3);
+    }
+    exit(EXIT_SUCCESS);
+  }
+
   if (opt_s)
   { // if -s option is given, use the sequence as secret sequence
     if (theSeq == NULL)
       theSeq = (int *)malloc(seqlen * sizeof(int));
     readSeq(theSeq, opt_s);
+    if (distinct && !validSeq(theSeq))
+    {
+      fprintf(stderr, "Secret sequence %d is not a code without repeated colours\n", opt_s);
+      exit(EXIT_FAILURE);
+    }
     if (verbose)
     {
       fprintf(stderr, "Running program with secret sequence:\n");
@@ -1002,15 +1802,43 @@ int main(int argc, char *argv[])
   }
 
   // -------------------------------------------------------
-  // LCD constants, hard-coded: 16x2 display, using a 4-bit connection
-  bits = 4;
+  // LCD constants, hard-coded: 16x2 display, using a 4-bit connection unless wired for 8 bits (-8)
+  bits = opt_8 ? 8 : 4;
   cols = 16;
   rows = 2;
   // -------------------------------------------------------
 
   printf("Raspberry Pi LCD driver, for a %dx%d display (%d-bit wiring) \n", cols, rows, bits);
 
-  if (geteuid() != 0)
+  if (opt_i == NULL || strcmp(opt_i, "button") == 0)
+    input = &buttonInput;
+  else if (strcmp(opt_i, "stdin") == 0)
+    input = &stdinInput;
+  else if (strcmp(opt_i, "keypad") == 0 || strncmp(opt_i, "keypad:", 7) == 0)
+  { // keypad[:<scan period in us>]
+    if (opt_i[6] != '\0')
+      keypadScanNs = strtoull(opt_i + 7, NULL, 0) * 1000;
+    if (!mmKeypadScanValid(keypadScanNs))
+      return failure(TRUE, "setup: keypad scan period of %llu us is too short for a %llu us debounce\n",
+                     (unsigned long long)keypadScanNs / 1000, (unsigned long long)MM_KEYPAD_DEBOUNCE_NS / 1000);
+    input = &keypadInput;
+  }
+  else if (mmInputScript(&scriptInput, opt_i, seqlen, colors, WINDOW * MM_NS_PER_MS) == 0)
+    input = &scriptInput;
+  else
+    return failure(TRUE, "setup: cannot read input script %s: %s\n", opt_i, strerror(errno));
+
+  // the I/O benchmark always runs against the in-memory registers, to be comparable across hosts
+  if (ioBench && !opt_H)
+    opt_H = "";
+  // other input sources do not need the button, so without access to the GPIOs play headless
+  if (input != &buttonInput && input != &keypadInput && !opt_H && geteuid() != 0)
+  {
+    opt_H = "";
+    if (verbose)
+      fprintf(stdout, "No access to the GPIOs, running headless on the virtual clock\n");
+  }
+  if (geteuid() != 0 && !opt_H)
     fprintf(stderr, "setup: Must be root. (Did you forget sudo?)\n");
 
   // init of guess sequence, and copies (for use in countMatches)
@@ -1026,13 +1854,48 @@ int main(int argc, char *argv[])
   // memory mapping
   // Open the master /dev/memory device
 
-  if ((fd = open("/dev/mem", O_RDWR | O_SYNC | O_CLOEXEC)) < 0)
-    return failure(FALSE, "setup: Unable to open /dev/mem: %s\n", strerror(errno));
+  if (!opt_H)
+  {
+    const char *step = NULL;
+    int err = 0;
+
+    if ((fd = open("/dev/mem", O_RDWR | O_SYNC | O_CLOEXEC)) < 0)
+      step = "Unable to open /dev/mem";
+    // GPIO:
+    else if ((gpio = (uint32_t *)mmap(0, BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, gpiobase)) == MAP_FAILED)
+      step = "mmap (GPIO) failed";
+    if (step != NULL)
+    {
+      err = errno;
+      if (fd >= 0)
+        close(fd);
+    }
+    // only the button and the keypad need the real GPIOs; other sources go on headless, e.g. as root in a container
+    if (step != NULL && (input == &buttonInput || input == &keypadInput))
+      return failure(TRUE, "setup: %s: %s\n", step, strerror(err));
+    if (step != NULL)
+    {
+      fprintf(stderr, "setup: %s: %s; running headless on the virtual clock\n", step, strerror(err));
+      opt_H = "";
+    }
+  }
+  if (opt_H)
+  { // headless: plain memory instead of the GPIO block, and the virtual clock
+    if ((gpio = mmSimInit(opt_H, BLOCK_SIZE)) == NULL)
+      return failure(TRUE, "setup: cannot allocate simulated GPIO block\n");
+    { // D0..D3 are only wired for 8 bits
+      const int lcdPins[8] = {opt_8 ? DATA0_8BIT_PIN : -1, opt_8 ? DATA1_8BIT_PIN : -1,
+                              opt_8 ? DATA2_8BIT_PIN : -1, opt_8 ? DATA3_8BIT_PIN : -1,
+                              DATA0_PIN, DATA1_PIN, DATA2_PIN, DATA3_PIN};
+
+      mmLcdEmuInit(&lcdEmu, RS_PIN, STRB_PIN, lcdPins);
+      mmSim->lcd = &lcdEmu;
+    }
+  }
 
-  // GPIO:
-  gpio = (uint32_t *)mmap(0, BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, gpiobase);
-  if ((int32_t)gpio == -1)
-    return failure(FALSE, "setup: mmap (GPIO) failed: %s\n", strerror(errno));
+  // pin the GPIO timing path to a CPU, at real-time priority, with memory locked
+  if (opt_rt && mmRtEnter(&rt, stderr) < 0)
+    fprintf(stderr, "Real-time mode only partly in effect\n");
 
   // -------------------------------------------------------
   // Configuration of LED, BUTTON and LCD pins
@@ -1046,109 +1909,24 @@ int main(int argc, char *argv[])
   pinMode(gpio, DATA1_PIN, OUTPUT);
   pinMode(gpio, DATA2_PIN, OUTPUT);
   pinMode(gpio, DATA3_PIN, OUTPUT);
-
-  // -------------------------------------------------------
-  // INLINED version of lcdInit (can only deal with one LCD attached to the RPi):
-  // you can use this code as-is, but you need to implement digitalWrite() and
-  // pinMode() which are called from this code
-  // Create a new LCD:
-  lcd = (struct lcdDataStruct *)malloc(sizeof(struct lcdDataStruct));
-  if (lcd == NULL)
-    return -1;
-
-  // hard-wired GPIO pins
-  lcd->rsPin = RS_PIN;
-  lcd->strbPin = STRB_PIN;
-  lcd->bits = 4;
-  lcd->rows = rows; // # of rows on the display
-  lcd->cols = cols; // # of cols on the display
-  lcd->cx = 0;      // x-pos of cursor
-  lcd->cy = 0;      // y-pos of curosr
-
-  lcd->dataPins[0] = DATA0_PIN;
-  lcd->dataPins[1] = DATA1_PIN;
-  lcd->dataPins[2] = DATA2_PIN;
-  lcd->dataPins[3] = DATA3_PIN;
-  // lcd->dataPins [4] = d4 ;
-  // lcd->dataPins [5] = d5 ;
-  // lcd->dataPins [6] = d6 ;
-  // lcd->dataPins [7] = d7 ;
-
-  // lcds [lcdFd] = lcd ;
-
-  digitalWrite(gpio, lcd->rsPin, 0);
-  pinMode(gpio, lcd->rsPin, OUTPUT);
-  digitalWrite(gpio, lcd->strbPin, 0);
-  pinMode(gpio, lcd->strbPin, OUTPUT);
-
-  for (i = 0; i < bits; ++i)
-  {
-    digitalWrite(gpio, lcd->dataPins[i], 0);
-    pinMode(gpio, lcd->dataPins[i], OUTPUT);
-  }
-  delay(35); // mS
-
-  // Gordon Henderson's explanation of this part of the init code (from wiringPi):
-  // 4-bit mode?
-  //	OK. This is a PIG and it's not at all obvious from the documentation I had,
-  //	so I guess some others have worked through either with better documentation
-  //	or more trial and error... Anyway here goes:
-  //
-  //	It seems that the controller needs to see the FUNC command at least 3 times
-  //	consecutively - in 8-bit mode. If you're only using 8-bit mode, then it appears
-  //	that you can get away with one func-set, however I'd not rely on it...
-  //
-  //	So to set 4-bit mode, you need to send the commands one nibble at a time,
-  //	the same three times, but send the command to set it into 8-bit mode those
-  //	three times, then send a final 4th command to set it into 4-bit mode, and only
-  //	then can you flip the switch for the rest of the library to work in 4-bit
-  //	mode which sends the commands as 2 x 4-bit values.
-
-  // Cool explainantion Mr. Henderson!
-
-  if (bits == 4)
-  {
-    func = LCD_FUNC | LCD_FUNC_DL; // Set 8-bit mode 3 times
-    lcdPut4Command(lcd, func >> 4);
-    delay(35);
-    lcdPut4Command(lcd, func >> 4);
-    delay(35);
-    lcdPut4Command(lcd, func >> 4);
-    delay(35);
-    func = LCD_FUNC; // 4th set: 4-bit mode
-    lcdPut4Command(lcd, func >> 4);
-    delay(35);
-    lcd->bits = 4;
-  }
-  else
+  if (input == &keypadInput)
   {
-    failure(TRUE, "setup: only 4-bit connection supported\n");
-    func = LCD_FUNC | LCD_FUNC_DL;
-    lcdPutCommand(lcd, func);
-    delay(35);
-    lcdPutCommand(lcd, func);
-    delay(35);
-    lcdPutCommand(lcd, func);
-    delay(35);
+    if (mmKeypadInit(&keypad, gpio, keypadScanNs) < 0)
+      return failure(TRUE, "setup: keypad scan period of %llu us is too short\n", (unsigned long long)keypadScanNs / 1000);
+    mmInputKeypad(&keypadInput, &keypad, colors, WINDOW * MM_NS_PER_MS);
   }
 
-  if (lcd->rows > 1)
+  // -------------------------------------------------------
+  // LCD, with a 4-bit or (option -8) an 8-bit connection
+  if ((lcd = lcdInit(rows, cols, bits)) == NULL)
+    return -1;
+  if (lcdBench)
   {
-    func |= LCD_FUNC_N;
-    lcdPutCommand(lcd, func);
-    delay(35);
+    lcdBenchmark(lcd, bits);
+    exit(EXIT_SUCCESS);
   }
-
-  // Rest of the initialisation sequence
-  lcdDisplay(lcd, TRUE);
-  lcdCursor(lcd, FALSE);
-  lcdCursorBlink(lcd, FALSE);
-  lcdClear(lcd);
-
-  lcdPutCommand(lcd, LCD_ENTRY | LCD_ENTRY_ID);     // set entry mode to increment address counter after write
-  lcdPutCommand(lcd, LCD_CDSHIFT | LCD_CDSHIFT_RL); // set display shift to right-to-left
-
-  // END lcdInit ------
+  if (ioBench)
+    exit(ioBenchmark(lcd) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
   // -----------------------------------------------------------------------------
   // Start of game
   fprintf(stderr, "Printing welcome message on the LCD display ...\n");
@@ -1166,6 +1944,26 @@ int main(int argc, char *argv[])
   if (TRUE)
     showSeq(theSeq);
 
+  if (opt_l)
+  {
+    struct timespec now;
+
+    if (!(logging = mmLogOpen(&gameLog, opt_l) == 0))
+      fprintf(stderr, "Cannot append to game log %s, playing without it\n", opt_l);
+    clock_gettime(CLOCK_REALTIME, &now);
+    memset(&rec, 0, sizeof(rec));
+    rec.kind = MM_LOG_GAME;
+    rec.len = seqlen;
+    rec.colors = colors;
+    rec.flags = distinct ? MM_LOG_DISTINCT : 0;
+    rec.code = mmEncode(&space, theSeq);
+    rec.seed = opt_r;
+    rec.ns = (uint64_t)now.tv_sec * MM_NS_PER_SEC + now.tv_nsec;
+    if (logging)
+      mmLogAppend(&gameLog, &rec);
+  }
+  gameStart = mmNow();
+
   // optionally one of these 2 calls:
   // waitForEnter();
   // waitForButton(gpio, pinButton);
@@ -1179,6 +1977,9 @@ int main(int argc, char *argv[])
   digitalWrite(gpio, greenLED, OFF);
   digitalWrite(gpio, redLED, OFF);
 
+  if (book.hdr != NULL && bookReached(bookNode))
+    showBookGuess(&space, bookNode);
+
   // Main game loop starts here, the player has 5 attempts to guess the secret sequence
   while (!found && attempts < 5)
   {
@@ -1187,41 +1988,43 @@ int main(int argc, char *argv[])
     // clear the lcd from previous round
     lcdClear(lcd);
 
+    roundStart = mmNow();
+    presses = 0;
+
     // print the round number on the terminal
     printf("Round %d!!!\n", attempts += 1);
+    MM_TRACE(MM_EV_ROUND, attempts, 0);
 
     // prints the round number on the lcd
     sprintf(buf, "Round: %d", attempts);
     lcdPosition(lcd, 0, 0);
     lcdPuts(lcd, buf);
+    if (lastCode >= 0)
+      lcdShowGuess(lcd, 1, lastGuess, lastCode);
 
     // main loop for each turn inputting the sequence
     while (1)
     {
       printf("Turn: %d\n", turn += 1);
       printf("Enter a sequence of %d numbers\n", seqlen);
-      // Time window of 5 seconds
-      time_t startTime = time(NULL);
-      time_t endTime = startTime + 5;
 
-      // Count of button presses
-      int buttonPressCount = 0;
+      // Count of button presses, or the number from another input source
+      int buttonPressCount;
 
       // Blink red when time window ends
-      while (time(NULL) < endTime)
-      {
-        // Wait for the button to be pressed
-        if (waitForButton(gpio, pinButton) == 1)
-        {
-          buttonPressCount++;
-          delay(500);
-        }
-        if (buttonPressCount >= 3)
-        {
-          buttonPressCount = 3;
-          break;
-        }
+      MM_PHASE_BEGIN(MM_PHASE_INPUT);
+      buttonPressCount = input->peg(input, turn - 1);
+      MM_PHASE_END(MM_PHASE_INPUT);
+      if (buttonPressCount < 0)
+      { // nothing more to play
+        printf("End of input\n");
+        endOfInput = TRUE;
+        break;
       }
+      MM_TRACE(MM_EV_INPUT, turn, buttonPressCount);
+      mmTracePoll(); // a dump asked for with SIGUSR2
+      lastPegAt = mmNow();
+      presses += buttonPressCount;
 
       // Print the number of button presses
       printf("Button pressed %d times\n", buttonPressCount);
@@ -1250,15 +2053,81 @@ int main(int argc, char *argv[])
       }
     }
 
-    // Compare the sequence with the secret sequence
+    if (endOfInput)
+      break;
+
+    // Compare the sequence with the secret sequence; countMatches overwrites attSeq
+    MM_PHASE_BEGIN(MM_PHASE_FEEDBACK);
+    guess = validSeq(attSeq) ? mmEncode(&space, attSeq) : space.size;
+    if (guess == space.size && distinct && seqInRange(attSeq))
+      printf("Not a code without repeated colours: this guess tells nothing about the candidates\n");
+    memcpy(lastGuess, attSeq, seqlen * sizeof(int));
     code = countMatches(theSeq, attSeq);
+    lastCode = code;
+    matchedAt = mmNow();
+    MM_LATENCY(MM_LAT_MATCH, matchedAt - lastPegAt);
 
     exact = code >> 4;        // Shift right by 4 bits to get the 'exact' value
     approximate = code & 0xF; // Bitwise AND with 0xF (which is 15 in decimal or 1111 in binary) to get the 'approximate' value
+    MM_TRACE(MM_EV_MATCH, exact, approximate);
 
     printf("Exact: %d\n", exact);
     printf("Approximate: %d\n", approximate);
 
+    if (logging)
+    {
+      rec.kind = MM_LOG_ROUND;
+      rec.round = attempts;
+      rec.score = code;
+      rec.code = guess;
+      rec.presses = presses;
+      rec.seed = 0;
+      rec.ns = lastPegAt - roundStart;
+      mmLogAppend(&gameLog, &rec);
+    }
+
+    // follow the opening book or the compiled-in strategy, as long as the player follows its suggestions
+    if (book.hdr != NULL)
+    {
+      if (guess == mmBookGuess(&book, bookNode) && exact != seqlen &&
+          (bookNode = mmBookChild(&book, bookNode, space.scoreIdx[code])) != 0)
+      {
+        if (bookReached(bookNode))
+          showBookGuess(&space, bookNode);
+      }
+      else
+        mmBookClose(&book);
+    }
+    if (genDepth >= 0)
+    {
+      if (guess == mmGenGuess(genScores, genDepth) && exact != seqlen && genDepth < (int)sizeof(genScores))
+        genScores[genDepth++] = code;
+      else
+        genDepth = -1;
+    }
+
+    // only the candidates left from the previous round need rescoring; an invalid guess tells nothing
+    if (guess < space.size && exact != seqlen)
+    {
+      uint64_t t0 = mmClockReal.now();
+
+      mmCandFilter(&cands, guess, code);
+      mmSymUpdate(&sym, &space, guess);
+      if (opt_g)
+        hint = book.hdr != NULL ? mmBookGuess(&book, bookNode)
+               : genDepth >= 0  ? mmGenGuess(genScores, genDepth)
+                                : mmHintGuess(&cands, &sym, space.size > HINT_BIG ? HINT_BUDGET_BIG : HINT_BUDGET);
+      if (verbose)
+        fprintf(stdout, "Candidate update took %.3f ms\n", (mmClockReal.now() - t0) / 1e6);
+    }
+    // after a win the candidates were not filtered, and there is nothing left to suggest
+    if (exact != seqlen)
+    {
+      printf("Candidates left: %u\n", cands.count);
+      if (hint < space.size && book.hdr == NULL) // the book's suggestion is shown above
+        showSeqCode(&space, "Try: ", hint);
+    }
+
     delay(500);
 
     if (exact == seqlen)
@@ -1269,8 +2138,8 @@ int main(int argc, char *argv[])
     // prints exact on the lcd
     lcdClear(lcd);
     blinkN(gpio, greenLED, exact);
-    sprintf(buf, "Exact: %d", exact);
-    lcdPosition(lcd, 1, 0);
+    sprintf(buf, "Exact:%d", exact);
+    lcdPosition(lcd, 0, 0);
     lcdPuts(lcd, buf);
 
     if (exact == seqlen)
@@ -1285,9 +2154,20 @@ int main(int argc, char *argv[])
 
     // prints approximate on the lcd
     blinkN(gpio, greenLED, approximate);
-    sprintf(buf, "Approx: %d", approximate);
-    lcdPosition(lcd, 0, 1);
+    sprintf(buf, " Approx:%d", approximate);
     lcdPuts(lcd, buf);
+    MM_LATENCY(MM_LAT_DISPLAY, mmNow() - matchedAt);
+
+    // and below, how many secrets are still possible
+    if (exact != seqlen)
+    {
+      candidatesRow(buf, lcd->cols, &space, cands.count, hint);
+      lcdPosition(lcd, 0, 1);
+      lcdPuts(lcd, buf);
+    }
+    MM_PHASE_END(MM_PHASE_FEEDBACK);
+    if (mmSim != NULL && verbose)
+      mmLcdEmuShow(stdout, &lcdEmu, lcd->cols);
 
     if (exact == seqlen)
     {
@@ -1329,7 +2209,39 @@ int main(int argc, char *argv[])
   {
     lcdClear(lcd);
     fprintf(stdout, "Sequence not found\n");
-    lcdPuts(lcd, "YOU LOSE!");
+    // reveal the secret; this does not fit on one row, so it scrolls past once
+    sprintf(buf, "YOU LOSE! Secret:");
+    for (int i = 0; i < seqlen; i++)
+      sprintf(buf + strlen(buf), " %d", theSeq[i]);
+    lcdScroll(lcd, 0, buf, 300);
+  }
+
+  if (logging)
+  { // the game is over, so now the log may take its time
+    rec.kind = MM_LOG_END;
+    rec.round = attempts;
+    rec.score = found ? 1 : 0;
+    rec.code = 0;
+    rec.presses = 0;
+    rec.ns = mmNow() - gameStart;
+    mmLogAppend(&gameLog, &rec);
+    if (mmLogClose(&gameLog) < 0)
+      fprintf(stderr, "Failed to write game log %s\n", opt_l);
+  }
+
+  if (verbose)
+    fprintf(stdout, "LCD glyphs: %llu uploaded, %llu reused from CGRAM\n", (unsigned long long)glyphs.uploads, (unsigned long long)glyphs.hits);
+  if (verbose && input == &keypadInput)
+    fprintf(stdout, "Keypad: %llu scans every %llu us, %llu keys pressed (%llu lost), %llu raw edges before debouncing\n",
+            (unsigned long long)keypad.scans, (unsigned long long)keypad.scanNs / 1000, (unsigned long long)keypad.presses,
+            (unsigned long long)keypad.lost, (unsigned long long)keypad.rawEdges);
+
+  // headless games are used as regression tests, so report the result in the exit code
+  if (mmSim != NULL)
+  {
+    mmSimReport(stdout, greenLED, redLED);
+    mmLcdEmuReport(stdout, &lcdEmu, cols);
+    return found ? 0 : 1;
   }
   return 0;
 }
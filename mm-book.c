@@ -0,0 +1,266 @@
+/*
+ * Opening book: building a decision tree, writing it to a file, and mapping
+ * it back in. See mm-book.h for the file layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mm-book.h"
+
+/* ======================================================= */
+/* SECTION: building the tree                              */
+/* ------------------------------------------------------- */
+
+static uint32_t *treeNode(struct mmTree *tr, uint32_t node)
+{
+  return tr->nodes + (size_t)node * MM_NODE_WORDS(tr->sp->nscores);
+}
+
+static int treeAlloc(struct mmTree *tr)
+{
+  size_t words = MM_NODE_WORDS(tr->sp->nscores);
+
+  if (tr->nnodes == tr->cap)
+  {
+    uint32_t cap = tr->cap ? 2 * tr->cap : 256;
+    uint32_t *nodes = (uint32_t *)realloc(tr->nodes, cap * words * sizeof(uint32_t));
+
+    if (nodes == NULL)
+      return -1;
+    tr->nodes = nodes;
+    tr->cap = cap;
+  }
+  memset(treeNode(tr, tr->nnodes), 0, words * sizeof(uint32_t));
+  return tr->nnodes++;
+}
+
+/* add the subtree for the candidates @cs@ at @depth@, returning its node */
+static int treeExpand(struct mmTree *tr, const struct mmCandidates *cs, const struct mmSymmetry *sy, int depth,
+                      mmChooser choose, void *ctx)
+{
+  const struct mmSpace *sp = tr->sp;
+  struct mmCandidates child;
+  struct mmSymmetry csy = *sy;
+  uint32_t counts[MM_MAX_SCORES];
+  int node = treeAlloc(tr);
+  mmCode guess;
+
+  if (node < 0)
+    return -1;
+  guess = choose != NULL ? choose(cs, sy, depth, ctx) : mmBestGuess(cs, sy, NULL);
+  treeNode(tr, node)[0] = guess;
+  if (depth > tr->maxDepth)
+    tr->maxDepth = depth;
+  if (mmBitsetTest(&cs->set, guess))
+    tr->totalGuesses += depth;
+
+  mmSymUpdate(&csy, sp, guess);
+  mmPartition(cs, guess, counts);
+  if (mmCandInit(&child, sp, cs->mt, cs->ix) < 0)
+    return -1;
+  for (int idx = 0; idx < sp->nscores; idx++)
+  {
+    int sub;
+
+    if (counts[idx] == 0 || sp->scoreVal[idx] == MM_WIN(sp))
+      continue;
+    memcpy(child.set.w, cs->set.w, cs->set.nwords * sizeof(uint64_t));
+    child.count = cs->count;
+    mmCandFilter(&child, guess, sp->scoreVal[idx]);
+    if ((sub = treeExpand(tr, &child, &csy, depth + 1, choose, ctx)) < 0)
+    {
+      mmCandFree(&child);
+      return -1;
+    }
+    treeNode(tr, node)[1 + idx] = sub;
+  }
+  mmCandFree(&child);
+  return node;
+}
+
+/* build a decision tree over the whole code space, choosing greedy guesses */
+int mmTreeBuild(struct mmTree *tr, const struct mmSpace *sp, const struct mmMaskTable *mt)
+{
+  return mmTreeBuildWith(tr, sp, mt, NULL, NULL);
+}
+
+/* build a decision tree over the whole code space, with guesses from @choose@ */
+int mmTreeBuildWith(struct mmTree *tr, const struct mmSpace *sp, const struct mmMaskTable *mt,
+                    mmChooser choose, void *ctx)
+{
+  struct mmCandidates cs;
+  struct mmSymmetry sy;
+  struct mmIndex ix;
+  int res;
+
+  memset(tr, 0, sizeof(*tr));
+  tr->sp = sp;
+  // without a mask table, filtering goes through the (much smaller) inverted index
+  ix.pos = NULL;
+  if (mt == NULL || mt->masks == NULL)
+    mmIndexBuild(&ix, sp, MM_INDEX_MAX_BYTES);
+  if (mmCandInit(&cs, sp, mt, &ix) < 0)
+  {
+    mmIndexFree(&ix);
+    return -1;
+  }
+  mmSymInit(&sy, sp);
+  res = treeExpand(tr, &cs, &sy, 1, choose, ctx);
+  mmCandFree(&cs);
+  mmIndexFree(&ix);
+  return res < 0 ? -1 : 0;
+}
+
+void mmTreeFree(struct mmTree *tr)
+{
+  free(tr->nodes);
+  tr->nodes = NULL;
+}
+
+/* ======================================================= */
+/* SECTION: book files                                     */
+/* ------------------------------------------------------- */
+
+int mmTreeWrite(const struct mmTree *tr, const char *path)
+{
+  struct mmBookHeader hdr;
+  size_t words = (size_t)tr->nnodes * MM_NODE_WORDS(tr->sp->nscores);
+  FILE *f;
+  int ok;
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, MM_BOOK_MAGIC, 4);
+  hdr.endian = MM_BOOK_ENDIAN;
+  hdr.version = MM_BOOK_VERSION;
+  hdr.headerSize = sizeof(hdr);
+  hdr.len = tr->sp->len;
+  hdr.colors = tr->sp->colors;
+  hdr.nscores = tr->sp->nscores;
+  hdr.maxDepth = tr->maxDepth;
+  hdr.nnodes = tr->nnodes;
+  hdr.totalGuesses = (uint32_t)tr->totalGuesses;
+  hdr.flags = tr->sp->distinct ? MM_BOOK_DISTINCT : 0;
+
+  if ((f = fopen(path, "wb")) == NULL)
+    return -1;
+  ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(tr->nodes, sizeof(uint32_t), words, f) == words;
+  if (fclose(f) != 0)
+    ok = 0;
+  return ok ? 0 : -1;
+}
+
+/* map a book read-only; pages are only read in as the game walks the tree */
+int mmBookOpen(struct mmBook *bk, const char *path)
+{
+  const struct mmBookHeader *hdr;
+  struct mmSpace sp;
+  struct stat st;
+  void *map;
+  int fd;
+
+  memset(bk, 0, sizeof(*bk));
+  if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+    return -1;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct mmBookHeader))
+  {
+    close(fd);
+    return -1;
+  }
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return -1;
+  madvise(map, st.st_size, MADV_RANDOM);
+
+  hdr = (const struct mmBookHeader *)map;
+  if (memcmp(hdr->magic, MM_BOOK_MAGIC, 4) != 0 || hdr->endian != MM_BOOK_ENDIAN ||
+      hdr->version != MM_BOOK_VERSION || hdr->headerSize != sizeof(*hdr) || hdr->nnodes == 0 ||
+      (size_t)st.st_size < sizeof(*hdr) + (size_t)hdr->nnodes * MM_NODE_WORDS(hdr->nscores) * sizeof(uint32_t) ||
+      ((hdr->flags & MM_BOOK_DISTINCT) ? mmSpaceInitDistinct : mmSpaceInit)(&sp, hdr->len, hdr->colors) < 0 ||
+      sp.nscores != hdr->nscores)
+  {
+    munmap(map, st.st_size);
+    return -1;
+  }
+
+  bk->hdr = hdr;
+  bk->nodes = (const uint32_t *)((const char *)map + hdr->headerSize);
+  bk->mapLen = st.st_size;
+  bk->size = sp.size;
+  return 0;
+}
+
+void mmBookClose(struct mmBook *bk)
+{
+  if (bk->hdr != NULL)
+    munmap((void *)bk->hdr, bk->mapLen);
+  bk->hdr = NULL;
+}
+
+/* ======================================================= */
+/* SECTION: trees as C code                                */
+/* ------------------------------------------------------- */
+
+/* the code for @node@, reached after @depth@ rounds, at indentation @ind@ */
+static void writeNodeC(FILE *f, const struct mmTree *tr, uint32_t node, int depth, int ind)
+{
+  const struct mmSpace *sp = tr->sp;
+  const uint32_t *nd = tr->nodes + (size_t)node * MM_NODE_WORDS(sp->nscores);
+  unsigned char g[MM_MAX_LEN];
+  int leaf = 1;
+
+  mmDecode(sp, nd[0], g);
+  fprintf(f, "%*sif (n == %d)\n%*s  return %u; //", ind, "", depth, ind, "", nd[0]);
+  for (int i = 0; i < sp->len; i++)
+    fprintf(f, " %d", g[i]);
+  fprintf(f, "\n");
+
+  for (int idx = 0; idx < sp->nscores; idx++)
+    if (nd[1 + idx] != 0)
+      leaf = 0;
+  if (leaf)
+    return;
+  fprintf(f, "%*sswitch (s[%d])\n%*s{\n", ind, "", depth, ind, "");
+  for (int idx = 0; idx < sp->nscores; idx++)
+    if (nd[1 + idx] != 0)
+    {
+      fprintf(f, "%*scase 0x%02x:\n", ind, "", sp->scoreVal[idx]);
+      writeNodeC(f, tr, nd[1 + idx], depth + 1, ind + 2);
+      fprintf(f, "%*s  break;\n", ind, "");
+    }
+  fprintf(f, "%*s}\n", ind, "");
+}
+
+/* write the tree as the C function mmGenGuess(), see mm-gentree.h */
+int mmTreeWriteC(const struct mmTree *tr, const char *path)
+{
+  FILE *f;
+  int ok;
+
+  if ((f = fopen(path, "w")) == NULL)
+    return -1;
+  fprintf(f, "/*\n * Generated by mm-solve -C, do not edit: the strategy for %dx%d%s, %u nodes,\n"
+             " * %.4f guesses on average, at most %d. See mm-gentree.h.\n */\n\n",
+          tr->sp->len, tr->sp->colors, tr->sp->distinct ? " without repeats" : "", tr->nnodes,
+          (double)tr->totalGuesses / tr->sp->size, tr->maxDepth);
+  // make GEN=1 defines MM_GENTREE on the command line as well
+  fprintf(f, "#ifndef MM_GENTREE\n#define MM_GENTREE\n#endif\n#include \"mm-gentree.h\"\n\n"
+             "const int mmGenLen = %d, mmGenColors = %d, mmGenDistinct = %d;\n\n",
+          tr->sp->len, tr->sp->colors, tr->sp->distinct);
+  fprintf(f, "mmCode mmGenGuess(const unsigned char *s, int n)\n{\n");
+  if (tr->nnodes > 0)
+    writeNodeC(f, tr, 0, 0, 2);
+  fprintf(f, "  return MM_GEN_NONE;\n}\n");
+  ok = !ferror(f);
+  if (fclose(f) != 0)
+    ok = 0;
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,101 @@
+/*
+ * Opening book: a complete decision tree for one (len, colours) configuration,
+ * stored in a compact binary file that the game maps read-only at startup.
+ *
+ * File layout (host byte order, checked via @endian@), all offsets are node
+ * numbers, so the file can be mapped anywhere:
+ *   struct mmBookHeader
+ *   nnodes x { uint32_t guess; uint32_t child[nscores]; }
+ * child[i] is the node to continue with after feedback scoreVal[i], or 0 if
+ * there is none (node 0 is the root, so it is never a child). Children always
+ * come after their parent. mmBookOpen() only checks the header, so that no
+ * page is read before it is needed; each node is checked as it is reached,
+ * and a corrupt one reads as MM_BOOK_BAD instead of leading out of bounds.
+ */
+
+#ifndef MM_BOOK_H
+#define MM_BOOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mm-solver.h"
+
+#define MM_BOOK_MAGIC "MMBK"
+#define MM_BOOK_VERSION 2
+#define MM_BOOK_ENDIAN 0x01020304
+
+struct mmBookHeader
+{
+  char magic[4];
+  uint32_t endian;
+  uint16_t version;
+  uint16_t headerSize;
+  uint8_t len, colors, nscores, maxDepth;
+  uint32_t nnodes;
+  uint32_t totalGuesses; // sum over all secrets of the guesses needed
+  uint32_t flags;
+};
+
+#define MM_BOOK_DISTINCT 1 // for the variant without repeated colours
+
+/* a decision tree in memory; same node layout as in the file */
+struct mmTree
+{
+  const struct mmSpace *sp;
+  uint32_t nnodes, cap;
+  uint32_t *nodes;
+  int maxDepth;
+  uint64_t totalGuesses;
+};
+
+#define MM_NODE_WORDS(nscores) (1 + (nscores))
+
+/* picks the guess for the candidates @cs@ at @depth@ (1 for the first guess) */
+typedef mmCode (*mmChooser)(const struct mmCandidates *cs, const struct mmSymmetry *sy, int depth, void *ctx);
+
+int mmTreeBuild(struct mmTree *tr, const struct mmSpace *sp, const struct mmMaskTable *mt);
+int mmTreeBuildWith(struct mmTree *tr, const struct mmSpace *sp, const struct mmMaskTable *mt,
+                    mmChooser choose, void *ctx);
+int mmTreeWrite(const struct mmTree *tr, const char *path);
+int mmTreeWriteC(const struct mmTree *tr, const char *path);
+void mmTreeFree(struct mmTree *tr);
+
+/* a book mapped from a file */
+struct mmBook
+{
+  const struct mmBookHeader *hdr;
+  const uint32_t *nodes;
+  size_t mapLen;
+  uint32_t size; // codes in the book's space
+};
+
+/* what mmBookGuess()/mmBookChild() give for a node that is out of bounds */
+#define MM_BOOK_BAD UINT32_MAX
+
+int mmBookOpen(struct mmBook *bk, const char *path);
+void mmBookClose(struct mmBook *bk);
+
+/* the guess to make at @node@, or MM_BOOK_BAD */
+static inline mmCode mmBookGuess(const struct mmBook *bk, uint32_t node)
+{
+  mmCode guess;
+
+  if (node >= bk->hdr->nnodes)
+    return MM_BOOK_BAD;
+  guess = bk->nodes[(size_t)node * MM_NODE_WORDS(bk->hdr->nscores)];
+  return guess < bk->size ? guess : MM_BOOK_BAD;
+}
+
+/* the node to continue with after feedback @scoreIdx@ at @node@, 0 if none, or MM_BOOK_BAD */
+static inline uint32_t mmBookChild(const struct mmBook *bk, uint32_t node, int scoreIdx)
+{
+  uint32_t child;
+
+  if (node >= bk->hdr->nnodes || scoreIdx < 0 || scoreIdx >= bk->hdr->nscores)
+    return MM_BOOK_BAD;
+  child = bk->nodes[(size_t)node * MM_NODE_WORDS(bk->hdr->nscores) + 1 + scoreIdx];
+  return child == 0 || (child > node && child < bk->hdr->nnodes) ? child : MM_BOOK_BAD;
+}
+
+#endif
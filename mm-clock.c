@@ -0,0 +1,46 @@
+/*
+ * The real and the virtual clock, see mm-clock.h.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+
+#include "mm-clock.h"
+
+static uint64_t realNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * MM_NS_PER_SEC + ts.tv_nsec;
+}
+
+/* sleep the full time, also when interrupted by a signal (e.g. a stats or trace dump) */
+static void realSleep(uint64_t ns)
+{
+  struct timespec req, rem;
+
+  req.tv_sec = ns / MM_NS_PER_SEC;
+  req.tv_nsec = ns % MM_NS_PER_SEC;
+  while (nanosleep(&req, &rem) < 0 && errno == EINTR)
+    req = rem;
+}
+
+/* virtual time; starts at 0 and only moves when someone sleeps */
+static uint64_t virtualTime;
+
+static uint64_t virtualNow(void)
+{
+  return virtualTime;
+}
+
+static void virtualSleep(uint64_t ns)
+{
+  virtualTime += ns;
+}
+
+const struct mmClock mmClockReal = {"real", realNow, realSleep};
+const struct mmClock mmClockVirtual = {"virtual", virtualNow, virtualSleep};
+
+const struct mmClock *mmClock = &mmClockReal;
@@ -0,0 +1,36 @@
+/*
+ * Clock abstraction for all timing in the game: delays, the input window and
+ * button polling go through mmNow()/mmSleep(). The real clock sleeps; the
+ * virtual one only advances its time to the end of each sleep, so a whole
+ * game runs in milliseconds (see mm-sim.h for the headless mode using it).
+ */
+
+#ifndef MM_CLOCK_H
+#define MM_CLOCK_H
+
+#include <stdint.h>
+
+#define MM_NS_PER_MS 1000000ULL
+#define MM_NS_PER_SEC 1000000000ULL
+
+struct mmClock
+{
+  const char *name;
+  uint64_t (*now)(void);      // monotonic time in ns
+  void (*sleep)(uint64_t ns); // wait until now() has advanced by @ns@
+};
+
+extern const struct mmClock mmClockReal, mmClockVirtual;
+extern const struct mmClock *mmClock;
+
+static inline uint64_t mmNow(void)
+{
+  return mmClock->now();
+}
+
+static inline void mmSleep(uint64_t ns)
+{
+  mmClock->sleep(ns);
+}
+
+#endif
@@ -0,0 +1,119 @@
+/*
+  Checks the decision tree compiled into mm-gentree.c (see mm-gentree.h)
+  against the book written by the same mm-solve run: every node must give the
+  book's guess, feedback without a child in the book must give no guess, and
+  every secret must be found in the book's number of guesses.
+
+$ ./mm-solve -l 4 -c 6 -o mm-gentree.mmb -C mm-gentree.c
+$ ./mm-gencheck mm-gentree.mmb
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mm-solver.h"
+#include "mm-book.h"
+#include "mm-gentree.h"
+
+#define MAX_DEPTH 32
+
+static uint32_t visited, mismatches;
+
+/* compare the subtree at @node@, reached with feedback @s@[0..n-1] */
+static void walk(const struct mmSpace *sp, const struct mmBook *bk, uint32_t node, unsigned char *s, int n)
+{
+  visited++;
+  if (mmGenGuess(s, n) != mmBookGuess(bk, node))
+  {
+    if (mismatches++ < 10)
+      fprintf(stderr, "node %u (depth %d): generated %u, book %u\n", node, n, mmGenGuess(s, n),
+              mmBookGuess(bk, node));
+    return;
+  }
+  if (n + 1 >= MAX_DEPTH)
+    return;
+  for (int idx = 0; idx < sp->nscores; idx++)
+  {
+    uint32_t child = mmBookChild(bk, node, idx);
+
+    s[n] = sp->scoreVal[idx];
+    if (child == MM_BOOK_BAD)
+    {
+      if (mismatches++ < 10)
+        fprintf(stderr, "node %u (depth %d): the book's child after feedback 0x%02x is out of bounds\n",
+                node, n, s[n]);
+    }
+    else if (child != 0)
+      walk(sp, bk, child, s, n + 1);
+    else if (mmGenGuess(s, n + 1) != MM_GEN_NONE)
+    {
+      if (mismatches++ < 10)
+        fprintf(stderr, "node %u (depth %d): generated a guess after feedback 0x%02x, the book has none\n",
+                node, n, s[n]);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  struct mmBook bk;
+  struct mmSpace sp;
+  unsigned char s[MAX_DEPTH];
+  uint64_t total = 0;
+
+  if (argc != 2 || strcmp(argv[1], "-h") == 0) {
+    fprintf(stderr, "Usage: %s <book written with the generated code>\n", argv[0]);
+    exit(argc == 2 ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  if (mmBookOpen(&bk, argv[1]) < 0) {
+    fprintf(stderr, "%s: not a book of this version\n", argv[1]);
+    exit(EXIT_FAILURE);
+  }
+  if (bk.hdr->len != mmGenLen || bk.hdr->colors != mmGenColors ||
+      !(bk.hdr->flags & MM_BOOK_DISTINCT) != !mmGenDistinct) {
+    fprintf(stderr, "** Book %s is for %dx%d%s, the generated code for %dx%d%s\n", argv[1], bk.hdr->len,
+	    bk.hdr->colors, bk.hdr->flags & MM_BOOK_DISTINCT ? " without repeats" : "", mmGenLen, mmGenColors,
+	    mmGenDistinct ? " without repeats" : "");
+    exit(EXIT_FAILURE);
+  }
+  if ((mmGenDistinct ? mmSpaceInitDistinct : mmSpaceInit)(&sp, mmGenLen, mmGenColors) < 0) {
+    fprintf(stderr, "Unsupported code space\n");
+    exit(EXIT_FAILURE);
+  }
+  if (mmGenDistinct)
+    mmSpacePack(&sp, MM_PACK_MAX_BYTES);
+
+  walk(&sp, &bk, 0, s, 0);
+
+  // play every secret with the generated code alone
+  for (mmCode secret = 0; secret < sp.size; secret++) {
+    int n;
+
+    for (n = 0; n < MAX_DEPTH; n++) {
+      mmCode guess = mmGenGuess(s, n);
+
+      if (guess == MM_GEN_NONE)
+	break;
+      if ((s[n] = mmScore(&sp, secret, guess)) == MM_WIN(&sp))
+	break;
+    }
+    if (n == MAX_DEPTH || mmGenGuess(s, n) == MM_GEN_NONE) {
+      if (mismatches++ < 10)
+	fprintf(stderr, "secret %u is not found\n", secret);
+      continue;
+    }
+    total += n + 1;
+  }
+
+  if (visited != bk.hdr->nnodes || total != bk.hdr->totalGuesses)
+    mismatches++;
+  fprintf(stderr, "%s: generated code for %dx%d%s, %u of %u nodes, %llu guesses over all secrets (book: %u)\n",
+	  mismatches ? "** MISMATCH" : "__ matches the book", mmGenLen, mmGenColors,
+	  mmGenDistinct ? " without repeats" : "", visited, bk.hdr->nnodes,
+	  (unsigned long long)total, bk.hdr->totalGuesses);
+  mmBookClose(&bk);
+  mmSpaceFree(&sp);
+  return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
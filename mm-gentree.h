@@ -0,0 +1,37 @@
+/*
+ * A decision tree compiled into the game: mm-solve -C writes the strategy
+ * for one (len, colours) configuration as C, nested switch statements on the
+ * feedback of each round so far, so the game needs no book file, no tables
+ * and no solver to suggest the next guess.
+ *
+ * The generated file is mm-gentree.c (make gen LEN=4 COLS=6, which also
+ * checks it against the solver's tree); the game uses it when built with
+ * make GEN=1. Otherwise mmGenGuess() below never suggests anything.
+ */
+
+#ifndef MM_GENTREE_H
+#define MM_GENTREE_H
+
+#include "mm-solver.h"
+
+#define MM_GEN_NONE 0xFFFFFFFFu // no guess: feedback not in the tree, or the game was won
+
+#ifdef MM_GENTREE
+extern const int mmGenLen, mmGenColors, mmGenDistinct;
+
+/* the guess after @n@ rounds with packed feedback @scores@[0..n-1] */
+mmCode mmGenGuess(const unsigned char *scores, int n);
+#else
+#define mmGenLen 0
+#define mmGenColors 0
+#define mmGenDistinct 0
+
+static inline mmCode mmGenGuess(const unsigned char *scores, int n)
+{
+  (void)scores;
+  (void)n;
+  return MM_GEN_NONE;
+}
+#endif
+
+#endif
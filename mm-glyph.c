@@ -0,0 +1,53 @@
+/*
+ * LRU cache of CGRAM slots, see mm-glyph.h.
+ */
+
+#include <stdint.h>
+
+#include "mm-glyph.h"
+
+/* all slots empty, e.g. after the display was initialised */
+void mmGlyphInit(struct mmGlyphCache *gc)
+{
+  for (int s = 0; s < MM_GLYPH_SLOTS; s++)
+  {
+    gc->id[s] = MM_GLYPH_NONE;
+    gc->lastUse[s] = 0;
+  }
+  gc->tick = 1;
+  gc->frameStart = 1;
+  gc->hits = gc->uploads = 0;
+}
+
+/* start drawing a new screen; glyphs used before may now be evicted */
+void mmGlyphFrame(struct mmGlyphCache *gc)
+{
+  gc->frameStart = ++gc->tick;
+}
+
+/* the slot holding glyph @id@; *@upload@ is set if its bitmap must be uploaded first.
+   -1 if all slots are taken by other glyphs of the current frame */
+int mmGlyphSlot(struct mmGlyphCache *gc, int id, int *upload)
+{
+  int victim = -1;
+
+  for (int s = 0; s < MM_GLYPH_SLOTS; s++)
+  {
+    if (gc->id[s] == id)
+    {
+      gc->lastUse[s] = ++gc->tick;
+      gc->hits++;
+      *upload = 0;
+      return s;
+    }
+    if (gc->lastUse[s] < gc->frameStart && (victim < 0 || gc->lastUse[s] < gc->lastUse[victim]))
+      victim = s;
+  }
+  if (victim < 0)
+    return -1;
+  gc->id[victim] = id;
+  gc->lastUse[victim] = ++gc->tick;
+  gc->uploads++;
+  *upload = 1;
+  return victim;
+}
@@ -0,0 +1,30 @@
+/*
+ * Cache of custom characters in the 8 CGRAM slots of an HD44780 display.
+ * Glyphs are identified by small integers chosen by the caller; a glyph that
+ * is already resident is reused, otherwise the least recently used slot is
+ * taken and the caller uploads the bitmap (a CGRAM address command and 8
+ * data writes). Slots used since the last mmGlyphFrame() are never evicted,
+ * since redefining a slot changes every character on screen that shows it.
+ */
+
+#ifndef MM_GLYPH_H
+#define MM_GLYPH_H
+
+#include <stdint.h>
+
+#define MM_GLYPH_SLOTS 8
+#define MM_GLYPH_NONE (-1)
+
+struct mmGlyphCache
+{
+  int id[MM_GLYPH_SLOTS];          // glyph in each slot, or MM_GLYPH_NONE
+  uint32_t lastUse[MM_GLYPH_SLOTS]; // tick of the last use
+  uint32_t tick, frameStart;
+  uint64_t hits, uploads;
+};
+
+void mmGlyphInit(struct mmGlyphCache *gc);
+void mmGlyphFrame(struct mmGlyphCache *gc);
+int mmGlyphSlot(struct mmGlyphCache *gc, int id, int *upload);
+
+#endif
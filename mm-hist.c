@@ -0,0 +1,45 @@
+/*
+ * Log-linear latency histograms, see mm-hist.h.
+ */
+
+#include <stdint.h>
+
+#include "mm-hist.h"
+
+/* the largest value that falls into bucket @idx@ */
+uint64_t mmHistBucketTop(int idx)
+{
+  int shift = (idx >> MM_HIST_SUB_BITS) - 1;
+  uint64_t sub = idx & (MM_HIST_SUB - 1);
+
+  if (shift < 0)
+    return (uint64_t)idx;
+  return (((MM_HIST_SUB | sub) + 1) << shift) - 1;
+}
+
+/* the value below which @perMille@/1000 of the recordings fall, to within a
+ * bucket; never more than the largest value recorded, 0 if there are none */
+uint64_t mmHistPercentile(const struct mmHist *h, unsigned perMille)
+{
+  uint64_t rank = (h->count * perMille + 999) / 1000, seen = 0;
+
+  if (rank == 0)
+    rank = 1;
+  for (int idx = 0; idx < MM_HIST_BUCKETS && h->count > 0; idx++)
+    if ((seen += h->buckets[idx]) >= rank)
+    {
+      uint64_t top = mmHistBucketTop(idx);
+
+      return top < h->max ? top : h->max;
+    }
+  return h->max;
+}
+
+void mmHistMerge(struct mmHist *dst, const struct mmHist *src)
+{
+  for (int idx = 0; idx < MM_HIST_BUCKETS; idx++)
+    dst->buckets[idx] += src->buckets[idx];
+  dst->count += src->count;
+  if (src->max > dst->max)
+    dst->max = src->max;
+}
@@ -0,0 +1,49 @@
+/*
+ * Latency histograms in the style of HdrHistogram: buckets are linear within
+ * each power of 2, with 2^MM_HIST_SUB_BITS buckets per power, so any value is
+ * known to within 1/16 (6.25%) over the whole 64-bit range, in a fixed 8 kB.
+ * Recording is a few instructions and never allocates; percentiles are read
+ * off the bucket counts. All arithmetic is on integers, so a histogram can be
+ * summarised from a signal handler.
+ */
+
+#ifndef MM_HIST_H
+#define MM_HIST_H
+
+#include <stdint.h>
+
+#define MM_HIST_SUB_BITS 4
+#define MM_HIST_SUB (1 << MM_HIST_SUB_BITS)
+#define MM_HIST_BUCKETS ((64 - MM_HIST_SUB_BITS + 1) * MM_HIST_SUB)
+
+struct mmHist
+{
+  uint64_t count, max;
+  uint64_t buckets[MM_HIST_BUCKETS];
+};
+
+/* values below MM_HIST_SUB have a bucket each; above, the top MM_HIST_SUB_BITS
+ * bits after the leading one select the bucket within the power of 2 */
+static inline int mmHistIndex(uint64_t v)
+{
+  int shift;
+
+  if (v < MM_HIST_SUB)
+    return (int)v;
+  shift = 63 - __builtin_clzll(v) - MM_HIST_SUB_BITS;
+  return ((shift + 1) << MM_HIST_SUB_BITS) + (int)((v >> shift) & (MM_HIST_SUB - 1));
+}
+
+static inline void mmHistRecord(struct mmHist *h, uint64_t v)
+{
+  h->buckets[mmHistIndex(v)]++;
+  h->count++;
+  if (v > h->max)
+    h->max = v;
+}
+
+uint64_t mmHistBucketTop(int idx);
+uint64_t mmHistPercentile(const struct mmHist *h, unsigned perMille);
+void mmHistMerge(struct mmHist *dst, const struct mmHist *src);
+
+#endif
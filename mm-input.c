@@ -0,0 +1,103 @@
+/*
+ * Scripted input of guesses, see mm-input.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "mm-input.h"
+#include "mm-solver.h"
+#include "mm-clock.h"
+
+static struct
+{
+  FILE *f;
+  int len, colors;
+  uint64_t windowNs;
+  int timed;              // the current line gives press times
+  int pegs[MM_MAX_LEN];   // presses per peg of the current line
+} script;
+
+/* the next line that is not blank or a comment, or NULL at the end */
+static char *nextLine(char *buf, int size)
+{
+  while (fgets(buf, size, script.f) != NULL)
+  {
+    char *p = buf;
+
+    while (isspace((unsigned char)*p))
+      p++;
+    if (*p != '\0' && *p != '#')
+      return p;
+  }
+  return NULL;
+}
+
+/* parse a guess, or press times per peg, into script.pegs */
+static void parseLine(char *p)
+{
+  int peg = 0;
+
+  memset(script.pegs, 0, sizeof(script.pegs));
+  if (!(script.timed = *p == '@'))
+  { // one number per peg; digits may also be run together, as in 123
+    for (; *p && peg < script.len; p++)
+      if (isdigit((unsigned char)*p))
+        script.pegs[peg++] = *p - '0';
+    return;
+  }
+
+  for (long last = -MM_INPUT_LOCKOUT_MS; *p && peg < script.len;)
+  {
+    char *end;
+    long ms = strtol(p, &end, 10);
+
+    if (end != p)
+    {
+      if (ms >= 0 && (uint64_t)ms * MM_NS_PER_MS < script.windowNs && ms - last >= MM_INPUT_LOCKOUT_MS &&
+          script.pegs[peg] < script.colors)
+      {
+        script.pegs[peg]++;
+        last = ms;
+      }
+      p = end;
+    }
+    else if (*p++ == '/')
+    {
+      peg++;
+      last = -MM_INPUT_LOCKOUT_MS;
+    }
+  }
+}
+
+static int scriptPeg(struct mmInput *in, int peg)
+{
+  char buf[256], *line;
+
+  (void)in;
+  if (peg == 0)
+  {
+    if ((line = nextLine(buf, sizeof(buf))) == NULL)
+      return -1;
+    parseLine(line);
+  }
+  if (script.timed)
+    mmSleep(script.windowNs);
+  return peg < script.len ? script.pegs[peg] : 0;
+}
+
+/* read guesses for sequences of @len@ pegs from the file or pipe @path@ */
+int mmInputScript(struct mmInput *in, const char *path, int len, int colors, uint64_t windowNs)
+{
+  if ((script.f = fopen(path, "r")) == NULL)
+    return -1;
+  script.len = len < MM_MAX_LEN ? len : MM_MAX_LEN;
+  script.colors = colors;
+  script.windowNs = windowNs;
+  in->name = "script";
+  in->peg = scriptPeg;
+  return 0;
+}
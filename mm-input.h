@@ -0,0 +1,37 @@
+/*
+ * Input sources for entering a guess, one peg at a time: the game loop asks
+ * its source for the number (of button presses) of each peg, whatever
+ * produces it. master-mind.c provides the button (counting presses in an
+ * input window) and stdin (readNum()) sources; this file provides scripts.
+ *
+ * A script is a file or pipe with one guess per line; blank lines and lines
+ * starting with '#' are skipped. A line is either the whole guess, one number
+ * per peg:
+ *   1 2 3
+ * or, starting with '@', the times of button presses in ms from the start of
+ * each peg's input window, with the pegs separated by '/':
+ *   @ 100 700 1300 / 250 / 90 600
+ * As with the real button, presses after the end of the window are lost, a
+ * press within MM_INPUT_LOCKOUT_MS of the last counted one is not counted (the
+ * button source pauses that long after each press), and the count is capped
+ * at the number of colours; the clock is advanced to the end of each window.
+ * Times must be ascending within a peg; pegs missing from a line are 0.
+ */
+
+#ifndef MM_INPUT_H
+#define MM_INPUT_H
+
+#include <stdint.h>
+
+#define MM_INPUT_LOCKOUT_MS 500 // pause of the button source after a counted press
+
+struct mmInput
+{
+  const char *name;
+  /* the presses for peg @peg@ (0-based) of the next guess, -1 at the end of input */
+  int (*peg)(struct mmInput *in, int peg);
+};
+
+int mmInputScript(struct mmInput *in, const char *path, int len, int colors, uint64_t windowNs);
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Keypad matrix scanning, debouncing and input of pegs, see mm-keypad.h.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mm-keypad.h"
+#include "mm-clock.h"
+#include "mm-sim.h"
+#include "mm-stats.h"
+
+/* GPIO registers, as word offsets */
+#define GPFSEL0 0
+#define GPSET0 (0x1C / 4)
+#define GPCLR0 (0x28 / 4)
+#define GPLEV0 (0x34 / 4)
+#define GPPUD (0x94 / 4)
+#define GPPUDCLK0 (0x98 / 4)
+
+#define PUD_UP 2
+#define PUD_WAIT_NS 5000 // the 150 cycles the pull-up control signal needs to set up and hold
+
+static const int rowPins[MM_KEYPAD_ROWS] = {12, 16, 20, 21};
+static const int colPins[MM_KEYPAD_COLS] = {9, 10, 11};
+
+static void setMode(volatile uint32_t *gpio, int pin, int output)
+{
+  volatile uint32_t *fsel = gpio + GPFSEL0 + pin / 10;
+  int shift = (pin % 10) * 3;
+
+  *fsel = (*fsel & ~(7u << shift)) | ((uint32_t)(output ? 1 : 0) << shift);
+}
+
+static void setRow(struct mmKeypad *kp, int r, int high)
+{
+  if (mmSim != NULL)
+    mmSimWrite(kp->rows[r], high);
+  kp->gpio[high ? GPSET0 : GPCLR0] = 1u << kp->rows[r];
+}
+
+/* scanning every @scanNs@: rows as outputs, idle high; columns as inputs with
+ * pull-ups, which takes the GPPUD/GPPUDCLK0 handshake of the BCM2835 */
+int mmKeypadInit(struct mmKeypad *kp, volatile uint32_t *gpio, uint64_t scanNs)
+{
+  uint32_t colMask = 0;
+
+  if (!mmKeypadScanValid(scanNs))
+    return -1;
+  memset(kp, 0, sizeof(*kp));
+  kp->gpio = gpio;
+  kp->scanNs = scanNs;
+  kp->debounce = (MM_KEYPAD_DEBOUNCE_NS + scanNs - 1) / scanNs;
+  memcpy(kp->rows, rowPins, sizeof(rowPins));
+  memcpy(kp->cols, colPins, sizeof(colPins));
+
+  for (int r = 0; r < MM_KEYPAD_ROWS; r++)
+  {
+    setRow(kp, r, 1);
+    setMode(gpio, kp->rows[r], 1);
+  }
+  for (int c = 0; c < MM_KEYPAD_COLS; c++)
+  {
+    setMode(gpio, kp->cols[c], 0);
+    colMask |= 1u << kp->cols[c];
+  }
+  gpio[GPPUD] = PUD_UP;
+  mmSleep(PUD_WAIT_NS);
+  gpio[GPPUDCLK0] = colMask;
+  mmSleep(PUD_WAIT_NS);
+  gpio[GPPUD] = 0;
+  gpio[GPPUDCLK0] = 0;
+  return 0;
+}
+
+/* one scan of all rows: update the debounced state and queue the keys that
+ * went down; returns the raw state, a bit per key */
+uint16_t mmKeypadScan(struct mmKeypad *kp)
+{
+  uint16_t raw = 0, any = 0, all = 0xFFFF, pressed;
+  uint64_t now;
+
+  for (int r = 0; r < MM_KEYPAD_ROWS; r++)
+  {
+    uint32_t lev;
+
+    setRow(kp, r, 0);
+    mmSleep(MM_KEYPAD_SETTLE_NS);
+    if (mmSim != NULL)
+      mmSimKeyRow(r, kp->cols, MM_KEYPAD_COLS);
+    lev = ~kp->gpio[GPLEV0]; // active low
+    setRow(kp, r, 1);
+    for (int c = 0; c < MM_KEYPAD_COLS; c++)
+      if (lev & (1u << kp->cols[c]))
+        raw |= 1u << (r * MM_KEYPAD_COLS + c);
+  }
+  now = mmNow();
+  kp->scans++;
+  kp->rawEdges += __builtin_popcount(raw ^ kp->history[kp->last]);
+  kp->last = (kp->last + 1) % kp->debounce;
+  kp->history[kp->last] = raw;
+
+  // a key is down once it was down in all of the last @debounce@ scans, and up
+  // once it was up in all of them
+  for (int i = 0; i < kp->debounce; i++)
+  {
+    any |= kp->history[i];
+    all &= kp->history[i];
+  }
+  pressed = all & ~kp->stable;
+  kp->stable = (kp->stable | all) & any;
+
+  for (int k = 0; k < MM_KEYPAD_KEYS; k++)
+  {
+    if (!(raw & (1u << k)))
+      kp->upAt[k] = now;
+    else if (pressed & (1u << k))
+    {
+      MM_LATENCY(MM_LAT_PRESS, now - kp->upAt[k]);
+      kp->presses++;
+      if (kp->tail - kp->head < MM_KEYPAD_QUEUE)
+        kp->queue[kp->tail++ % MM_KEYPAD_QUEUE] = k;
+      else
+        kp->lost++;
+    }
+  }
+  return raw;
+}
+
+/* the label of the next key pressed, scanning every scanNs for up to
+ * @timeoutNs@; -1 if none was */
+int mmKeypadGet(struct mmKeypad *kp, uint64_t timeoutNs)
+{
+  uint64_t end = mmNow() + timeoutNs;
+
+  while (kp->head == kp->tail)
+  {
+    uint64_t next = mmNow() + kp->scanNs;
+
+    if (mmNow() >= end)
+      return -1;
+    mmKeypadScan(kp);
+    if (mmNow() < next)
+      mmSleep(next - mmNow());
+  }
+  return MM_KEYPAD_LABELS[kp->queue[kp->head++ % MM_KEYPAD_QUEUE]];
+}
+
+/* SECTION: input source */
+
+static struct
+{
+  struct mmKeypad *kp;
+  int colors;
+  uint64_t windowNs;
+} input;
+
+/* one key per peg: the first colour key within the input window, or 0 */
+static int keypadPeg(struct mmInput *in, int peg)
+{
+  uint64_t end = mmNow() + input.windowNs;
+  int key;
+
+  (void)in;
+  (void)peg;
+  if (mmSim != NULL)
+    mmSimInput();
+  while (mmNow() < end && (key = mmKeypadGet(input.kp, end - mmNow())) >= 0)
+    if (key >= '1' && key <= '0' + input.colors)
+      return key - '0';
+  return 0;
+}
+
+/* take guesses from @kp@, pegs in @colors@ colours, waiting @windowNs@ per peg */
+int mmInputKeypad(struct mmInput *in, struct mmKeypad *kp, int colors, uint64_t windowNs)
+{
+  input.kp = kp;
+  input.colors = colors;
+  input.windowNs = windowNs;
+  in->name = "keypad";
+  in->peg = keypadPeg;
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * A keypad matrix for entering guesses, one key per peg instead of counting
+ * presses of the button in a 5 s window (option -i keypad).
+ *
+ * The keypad is a 3x4 phone layout on spare GPIOs:
+ *          col 0  col 1  col 2   (GPIO 9, 10, 11: inputs, pulled up)
+ *   row 0    1      2      3     (GPIO 12)
+ *   row 1    4      5      6     (GPIO 16)
+ *   row 2    7      8      9     (GPIO 20)
+ *   row 3    *      0      #     (GPIO 21: rows are outputs, idle high)
+ * A scan drives one row low at a time and reads the columns of all keys in
+ * the row from one GPLEV0 word, so any number of keys can be down at once
+ * (keypads without a diode per key show ghost keys for 3 or more, though).
+ * A key only changes state once the scans over MM_KEYPAD_DEBOUNCE_NS agree, which, as
+ * the scans are kept as bitmasks of all 12 keys, is an AND and an OR over
+ * the last few scans. Every key that goes down is queued, in key order for
+ * several in one scan, so fast typing is not lost (rollover).
+ *
+ * The time from the last scan that saw a key up to it being registered is
+ * recorded as the press latency (see mm-stats.h).
+ */
+
+#ifndef MM_KEYPAD_H
+#define MM_KEYPAD_H
+
+#include <stdint.h>
+
+#include "mm-input.h"
+
+#define MM_KEYPAD_ROWS 4
+#define MM_KEYPAD_COLS 3
+#define MM_KEYPAD_KEYS (MM_KEYPAD_ROWS * MM_KEYPAD_COLS)
+#define MM_KEYPAD_MAX_DEBOUNCE 64
+#define MM_KEYPAD_QUEUE 16 // a power of 2
+
+#define MM_KEYPAD_SCAN_NS (1 * 1000000ULL)     // default scan period
+#define MM_KEYPAD_DEBOUNCE_NS (5 * 1000000ULL) // a key must be stable for, rounded up to whole scans
+#define MM_KEYPAD_SETTLE_NS 5000           // after driving a row, before reading the columns
+
+/* key labels, row by row */
+#define MM_KEYPAD_LABELS "123456789*0#"
+
+struct mmKeypad
+{
+  volatile uint32_t *gpio;
+  int rows[MM_KEYPAD_ROWS], cols[MM_KEYPAD_COLS]; // GPIO pins
+  uint64_t scanNs;
+  int debounce;                             // scans a key must be stable for
+  uint16_t history[MM_KEYPAD_MAX_DEBOUNCE]; // raw scans, a bit per key
+  int last;                                 // latest entry in history
+  uint16_t stable;                          // debounced state
+  uint64_t upAt[MM_KEYPAD_KEYS];            // last scan seeing each key up
+  unsigned char queue[MM_KEYPAD_QUEUE];     // keys gone down, not yet taken
+  unsigned head, tail;
+  uint64_t scans, presses, rawEdges, lost;
+};
+
+/* whether the debounce time fits into the history at a scan period of @scanNs@ */
+static inline int mmKeypadScanValid(uint64_t scanNs)
+{
+  return scanNs != 0 && (MM_KEYPAD_DEBOUNCE_NS + scanNs - 1) / scanNs <= MM_KEYPAD_MAX_DEBOUNCE;
+}
+
+int mmKeypadInit(struct mmKeypad *kp, volatile uint32_t *gpio, uint64_t scanNs);
+uint16_t mmKeypadScan(struct mmKeypad *kp);
+int mmKeypadGet(struct mmKeypad *kp, uint64_t timeoutNs);
+int mmInputKeypad(struct mmInput *in, struct mmKeypad *kp, int colors, uint64_t windowNs);
+
+#endif
@@ -0,0 +1,318 @@
+/*
+ * HD44780 controller emulator, see mm-lcdemu.h.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mm-lcdemu.h"
+
+/* datasheet timings, ns */
+#define PW_EH 450        // E pulse width, high
+#define T_CYCE 1000      // E cycle time
+#define T_AS 60          // RS setup before E rises
+#define T_DSW 195        // data setup before E falls
+#define T_H 10           // hold after E falls
+#define T_EXEC 37000     // most instructions
+#define T_DATA 41000     // a data write, including the address update
+#define T_CLEAR 1520000  // clear display and return home
+#define T_RESET1 4100000 // after the first function set of the reset handshake
+#define T_RESET2 100000  // after the second
+
+static const char *const violationNames[MM_LCD_NVIOLATIONS] = {"busy", "E pulse", "E cycle", "setup", "hold"};
+
+static void violation(struct mmLcdEmu *lcd, enum mmLcdViolation v, uint64_t t, uint64_t ns)
+{
+  if (mmLcdEmuViolations(lcd) == 0)
+    snprintf(lcd->first, sizeof(lcd->first), "%s at %.6f s (%llu ns short)", violationNames[v], t / 1e9,
+             (unsigned long long)ns);
+  lcd->violations[v]++;
+}
+
+/* SECTION: controller */
+
+/* index into ddram of address @addr@ */
+static int ddramIndex(const struct mmLcdEmu *lcd, uint8_t addr)
+{
+  if (!lcd->twoLines)
+    return addr % MM_LCD_DDRAM;
+  return (addr & 0x40 ? MM_LCD_DDRAM / 2 : 0) + (addr & 0x3F) % (MM_LCD_DDRAM / 2);
+}
+
+/* move the address counter by one, wrapping from the end of one line to the start of the next */
+static void advance(struct mmLcdEmu *lcd)
+{
+  if (lcd->toCgram)
+  {
+    lcd->ac = (lcd->ac + (lcd->increment ? 1 : -1)) & (MM_LCD_CGRAM - 1);
+    return;
+  }
+  if (!lcd->twoLines)
+    lcd->ac = lcd->increment ? (lcd->ac + 1) % MM_LCD_DDRAM : (lcd->ac + MM_LCD_DDRAM - 1) % MM_LCD_DDRAM;
+  else if (lcd->increment)
+    lcd->ac = lcd->ac == 0x27 ? 0x40 : lcd->ac == 0x67 ? 0x00 : lcd->ac + 1;
+  else
+    lcd->ac = lcd->ac == 0x40 ? 0x27 : lcd->ac == 0x00 ? 0x67 : lcd->ac - 1;
+}
+
+/* shift the display by one character, to the left if @left@ */
+static void shiftDisplay(struct mmLcdEmu *lcd, int left)
+{
+  int width = lcd->twoLines ? MM_LCD_DDRAM / 2 : MM_LCD_DDRAM;
+
+  lcd->shift = (lcd->shift + (left ? 1 : width - 1)) % width;
+}
+
+/* execute instruction (@rs@ 0) or data write (@rs@ 1) @byte@; returns its execution time */
+static uint64_t execute(struct mmLcdEmu *lcd, int rs, uint8_t byte)
+{
+  int reset = 0;
+  uint64_t exec = T_EXEC;
+
+  if (rs)
+  {
+    lcd->data++;
+    if (lcd->toCgram)
+      lcd->cgram[lcd->ac & (MM_LCD_CGRAM - 1)] = byte;
+    else
+    {
+      lcd->ddram[ddramIndex(lcd, lcd->ac)] = byte;
+      if (lcd->autoShift)
+        shiftDisplay(lcd, lcd->increment);
+    }
+    advance(lcd);
+    lcd->resets = 0;
+    return T_DATA;
+  }
+
+  lcd->commands++;
+  if (byte & 0x80)
+  { // set DDRAM address
+    lcd->ac = byte & 0x7F;
+    lcd->toCgram = 0;
+  }
+  else if (byte & 0x40)
+  { // set CGRAM address
+    lcd->ac = byte & 0x3F;
+    lcd->toCgram = 1;
+  }
+  else if (byte & 0x20)
+  { // function set
+    lcd->eightBit = (byte & 0x10) != 0;
+    lcd->twoLines = (byte & 0x08) != 0;
+    lcd->bigFont = (byte & 0x04) != 0;
+    lcd->pending = 0;
+    if (lcd->eightBit)
+    { // the reset handshake: the first two need longer than a normal instruction
+      reset = 1;
+      if (++lcd->resets == 1)
+        exec = T_RESET1;
+      else if (lcd->resets == 2)
+        exec = T_RESET2;
+    }
+  }
+  else if (byte & 0x10)
+  { // cursor or display shift
+    if (byte & 0x08)
+      shiftDisplay(lcd, !(byte & 0x04));
+    else
+    {
+      int inc = lcd->increment;
+
+      lcd->increment = (byte & 0x04) != 0;
+      advance(lcd);
+      lcd->increment = inc;
+    }
+  }
+  else if (byte & 0x08)
+  { // display on/off control
+    lcd->displayOn = (byte & 0x04) != 0;
+    lcd->cursorOn = (byte & 0x02) != 0;
+    lcd->blinkOn = (byte & 0x01) != 0;
+  }
+  else if (byte & 0x04)
+  { // entry mode set
+    lcd->increment = (byte & 0x02) != 0;
+    lcd->autoShift = (byte & 0x01) != 0;
+  }
+  else if (byte & 0x02)
+  { // return home
+    lcd->ac = 0;
+    lcd->toCgram = 0;
+    lcd->shift = 0;
+    exec = T_CLEAR;
+  }
+  else if (byte & 0x01)
+  { // clear display
+    memset(lcd->ddram, ' ', sizeof(lcd->ddram));
+    lcd->ac = 0;
+    lcd->toCgram = 0;
+    lcd->shift = 0;
+    lcd->increment = 1;
+    exec = T_CLEAR;
+  }
+  if (!reset)
+    lcd->resets = 0;
+  return exec;
+}
+
+/* SECTION: bus */
+
+/* E fell at @t@: latch RS and the data lines */
+static void latch(struct mmLcdEmu *lcd, uint64_t t)
+{
+  int rs = lcd->levels & (1 << MM_LCD_RS) ? 1 : 0;
+  uint8_t bus = lcd->levels >> MM_LCD_D0;
+  uint64_t start = t;
+
+  lcd->cycles++;
+  if (!lcd->eightBit)
+  { // two nibbles, high first; the instruction starts with the first
+    if (!lcd->pending)
+    {
+      lcd->pending = 1;
+      lcd->high = bus >> 4;
+      lcd->highRs = rs;
+      lcd->highAt = t;
+      return;
+    }
+    lcd->pending = 0;
+    bus = (lcd->high << 4) | (bus >> 4);
+    rs = lcd->highRs;
+    start = lcd->highAt;
+  }
+  if (start < lcd->busyUntil)
+    violation(lcd, MM_LCD_BUSY, start, lcd->busyUntil - start);
+  lcd->busyUntil = t + execute(lcd, rs, bus);
+}
+
+/* the controller as after power-on, with RS, E and D0..D7 on the given GPIO pins (-1 if not wired) */
+void mmLcdEmuInit(struct mmLcdEmu *lcd, int rsPin, int ePin, const int dataPins[8])
+{
+  memset(lcd, 0, sizeof(*lcd));
+  memset(lcd->line, -1, sizeof(lcd->line));
+  if (rsPin >= 0)
+    lcd->line[rsPin % 32] = MM_LCD_RS;
+  if (ePin >= 0)
+    lcd->line[ePin % 32] = MM_LCD_E;
+  for (int i = 0; i < 8; i++)
+    if (dataPins[i] >= 0)
+      lcd->line[dataPins[i] % 32] = MM_LCD_D0 + i;
+
+  memset(lcd->ddram, ' ', sizeof(lcd->ddram));
+  lcd->eightBit = 1;
+  lcd->increment = 1;
+}
+
+/* @pin@ was set to @value@ at @now@ */
+void mmLcdEmuPin(struct mmLcdEmu *lcd, int pin, int value, uint64_t now)
+{
+  int l = lcd->line[pin % 32];
+  uint16_t bit;
+  uint64_t t;
+
+  if (l < 0)
+    return;
+  t = now > lcd->now + MM_LCD_WRITE_NS ? now : lcd->now + MM_LCD_WRITE_NS;
+  lcd->now = t;
+  bit = 1 << l;
+  if (!value == !(lcd->levels & bit))
+    return;
+  lcd->levels ^= bit;
+
+  if (l != MM_LCD_E)
+  {
+    if (lcd->cycles > 0 && t - lcd->fallE < T_H)
+      violation(lcd, MM_LCD_HOLD, t, T_H - (t - lcd->fallE));
+    lcd->changed[l] = t;
+  }
+  else if (value)
+  { // rising edge
+    if (lcd->changed[MM_LCD_RS] > 0 && t - lcd->changed[MM_LCD_RS] < T_AS)
+      violation(lcd, MM_LCD_SETUP, t, T_AS - (t - lcd->changed[MM_LCD_RS]));
+    if (lcd->cycles > 0 && t - lcd->riseE < T_CYCE)
+      violation(lcd, MM_LCD_CYCLE, t, T_CYCE - (t - lcd->riseE));
+    lcd->riseE = t;
+  }
+  else
+  { // falling edge: latch
+    uint64_t lastData = 0;
+
+    for (int i = MM_LCD_D0; i < MM_LCD_LINES; i++)
+      if (lcd->changed[i] > lastData)
+        lastData = lcd->changed[i];
+    if (t - lcd->riseE < PW_EH)
+      violation(lcd, MM_LCD_PULSE, t, PW_EH - (t - lcd->riseE));
+    if (lastData > 0 && t - lastData < T_DSW)
+      violation(lcd, MM_LCD_SETUP, t, T_DSW - (t - lastData));
+    lcd->fallE = t;
+    latch(lcd, t);
+  }
+}
+
+/* the @cols@ characters visible in @row@, as character codes, into @buf@ (with a terminating 0);
+ * blank if the display is off */
+void mmLcdEmuRow(const struct mmLcdEmu *lcd, int row, int cols, char *buf)
+{
+  int width = lcd->twoLines ? MM_LCD_DDRAM / 2 : MM_LCD_DDRAM;
+
+  for (int c = 0; c < cols; c++)
+  {
+    int i = (c + lcd->shift) % width;
+
+    if (!lcd->displayOn || (row > 0 && !lcd->twoLines) || row >= MM_LCD_ROWS)
+      buf[c] = ' ';
+    else
+      buf[c] = lcd->ddram[row * width + i];
+  }
+  buf[cols] = '\0';
+}
+
+uint64_t mmLcdEmuViolations(const struct mmLcdEmu *lcd)
+{
+  uint64_t n = 0;
+
+  for (int v = 0; v < MM_LCD_NVIOLATIONS; v++)
+    n += lcd->violations[v];
+  return n;
+}
+
+/* what the display shows, custom characters as '#' */
+void mmLcdEmuShow(FILE *f, const struct mmLcdEmu *lcd, int cols)
+{
+  char buf[MM_LCD_DDRAM + 1];
+
+  if (cols > MM_LCD_DDRAM)
+    cols = MM_LCD_DDRAM;
+  for (int r = 0; r < MM_LCD_ROWS; r++)
+  {
+    mmLcdEmuRow(lcd, r, cols, buf);
+    for (int c = 0; c < cols; c++)
+      if ((unsigned char)buf[c] < 0x10)
+        buf[c] = '#';
+      else if ((unsigned char)buf[c] < ' ' || (unsigned char)buf[c] > '~')
+        buf[c] = '?';
+    fprintf(f, "  |%s|\n", buf);
+  }
+}
+
+/* the display state and contents, and the bus statistics */
+void mmLcdEmuReport(FILE *f, const struct mmLcdEmu *lcd, int cols)
+{
+  fprintf(f, "LCD %s, %d line%s, cursor %s, shift %d:\n", lcd->displayOn ? "on" : "off", lcd->twoLines ? 2 : 1,
+          lcd->twoLines ? "s" : "", lcd->cursorOn ? (lcd->blinkOn ? "blinking" : "on") : "off", lcd->shift);
+  mmLcdEmuShow(f, lcd, cols);
+  fprintf(f, "LCD bus: %llu E cycles, %llu instructions, %llu data bytes, %d-bit interface; ",
+          (unsigned long long)lcd->cycles, (unsigned long long)lcd->commands, (unsigned long long)lcd->data,
+          lcd->eightBit ? 8 : 4);
+  if (mmLcdEmuViolations(lcd) == 0)
+    fprintf(f, "no timing violations\n");
+  else
+  {
+    for (int v = 0; v < MM_LCD_NVIOLATIONS; v++)
+      if (lcd->violations[v] != 0)
+        fprintf(f, "%llu %s, ", (unsigned long long)lcd->violations[v], violationNames[v]);
+    fprintf(f, "first: %s\n", lcd->first);
+  }
+}
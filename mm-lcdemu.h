@@ -0,0 +1,86 @@
+/*
+ * Emulation of an HD44780 LCD controller, fed with the pin writes of the
+ * headless mode (mm-sim.h), so that what the game shows on the display can
+ * be checked without one.
+ *
+ * The emulator sees the bus as the display does: it tracks the levels of RS,
+ * E and D0..D7, latches RS and the data lines on each falling edge of E, and
+ * pairs nibbles when the interface is 4 bits wide. The controller starts as
+ * after power-on, in 8-bit mode, so the reset handshake of lcdInit() (the
+ * function set 0x3 three times, then 0x2) is decoded like any other
+ * instruction. DDRAM (2 lines of 40, or 1 of 80), CGRAM, the address counter,
+ * entry mode, display and cursor shifts are modelled; the busy flag is not
+ * read (R/W is tied low), so instructions sent before the previous one has
+ * finished are reported as violations, as are E pulses and setup times that
+ * are too short for the datasheet (fosc 270 kHz). Violating instructions are
+ * still executed, so that one slip does not garble the rest of the check.
+ *
+ * Time is taken from the caller (the virtual clock); several writes at the
+ * same instant are spread MM_LCD_WRITE_NS apart, the least a write to the
+ * GPIO block takes.
+ */
+
+#ifndef MM_LCDEMU_H
+#define MM_LCDEMU_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define MM_LCD_WRITE_NS 20 // between back-to-back pin writes
+
+/* bus lines */
+#define MM_LCD_RS 0
+#define MM_LCD_E 1
+#define MM_LCD_D0 2 // D0..D7 follow
+#define MM_LCD_LINES 10
+
+/* timing rules checked */
+enum mmLcdViolation
+{
+  MM_LCD_BUSY,   // instruction before the previous one was executed
+  MM_LCD_PULSE,  // E high for less than PW_EH
+  MM_LCD_CYCLE,  // E rising edges less than tcycE apart
+  MM_LCD_SETUP,  // RS not stable tAS before E rises, or data tDSW before E falls
+  MM_LCD_HOLD,   // RS or data changed within tH after E fell
+  MM_LCD_NVIOLATIONS
+};
+
+#define MM_LCD_ROWS 2
+#define MM_LCD_DDRAM 80
+#define MM_LCD_CGRAM 64
+
+struct mmLcdEmu
+{
+  int8_t line[32];  // bus line wired to each GPIO pin, -1 if none
+  uint16_t levels;  // bit per bus line
+  uint64_t now;     // time of the last write
+  uint64_t changed[MM_LCD_LINES]; // time of the last change per line
+  uint64_t riseE, fallE;
+  uint64_t busyUntil; // the current instruction is executed at this time
+  /* interface */
+  int eightBit;      // bus width, 8 after power-on
+  int pending;       // 4 bits: high nibble latched, waiting for the low one
+  uint8_t high;      // pending nibble, and RS and time it came with
+  int highRs;
+  uint64_t highAt;
+  int resets;        // consecutive 8-bit function sets, see the reset handshake
+  /* controller */
+  uint8_t ddram[MM_LCD_DDRAM], cgram[MM_LCD_CGRAM];
+  uint8_t ac;        // address counter
+  int toCgram;       // ac addresses CGRAM
+  int twoLines, bigFont, displayOn, cursorOn, blinkOn, increment, autoShift;
+  int shift;         // display shift, in characters to the left
+  /* counters */
+  uint64_t cycles, commands, data;
+  uint64_t violations[MM_LCD_NVIOLATIONS];
+  char first[96];    // the first violation
+};
+
+void mmLcdEmuInit(struct mmLcdEmu *lcd, int rsPin, int ePin, const int dataPins[8]);
+void mmLcdEmuPin(struct mmLcdEmu *lcd, int pin, int value, uint64_t now);
+void mmLcdEmuRow(const struct mmLcdEmu *lcd, int row, int cols, char *buf);
+uint64_t mmLcdEmuViolations(const struct mmLcdEmu *lcd);
+void mmLcdEmuShow(FILE *f, const struct mmLcdEmu *lcd, int cols);
+void mmLcdEmuReport(FILE *f, const struct mmLcdEmu *lcd, int cols);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Buffered writer and mapped reader of game logs, see mm-log.h.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mm-log.h"
+
+static uint64_t monoNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int headerOk(const struct mmLogHeader *hdr)
+{
+  return memcmp(hdr->magic, MM_LOG_MAGIC, 4) == 0 && hdr->endian == MM_LOG_ENDIAN &&
+         hdr->version == MM_LOG_VERSION && hdr->headerSize == sizeof(*hdr) &&
+         hdr->recordSize == sizeof(struct mmLogRecord);
+}
+
+static int writeAll(int fd, const void *buf, size_t len)
+{
+  const char *p = (const char *)buf;
+
+  while (len > 0)
+  {
+    ssize_t w = write(fd, p, len);
+
+    if (w <= 0)
+      return -1;
+    p += w;
+    len -= w;
+  }
+  return 0;
+}
+
+/* ======================================================= */
+/* SECTION: writer                                         */
+/* ------------------------------------------------------- */
+
+/* open @path@ for appending, creating it with a header if it is new or empty;
+ * fails if it is not a log of this version */
+int mmLogOpen(struct mmLog *lg, const char *path)
+{
+  struct mmLogHeader hdr;
+  struct stat st;
+
+  memset(lg, 0, sizeof(*lg));
+  if ((lg->fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644)) < 0)
+    return -1;
+  if (fstat(lg->fd, &st) < 0)
+    goto fail;
+
+  if (st.st_size == 0)
+  {
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, MM_LOG_MAGIC, 4);
+    hdr.endian = MM_LOG_ENDIAN;
+    hdr.version = MM_LOG_VERSION;
+    hdr.headerSize = sizeof(hdr);
+    hdr.recordSize = sizeof(struct mmLogRecord);
+    if (writeAll(lg->fd, &hdr, sizeof(hdr)) < 0)
+      goto fail;
+  }
+  else if (pread(lg->fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) || !headerOk(&hdr))
+    goto fail;
+  else if ((st.st_size - sizeof(hdr)) % sizeof(struct mmLogRecord) != 0)
+  { // cut off a partial record left by a crash, so that new records stay aligned
+    off_t whole = st.st_size - (st.st_size - sizeof(hdr)) % sizeof(struct mmLogRecord);
+
+    if (ftruncate(lg->fd, whole) < 0)
+      goto fail;
+  }
+
+  lg->lastSync = monoNs();
+  return 0;
+
+fail:
+  close(lg->fd);
+  lg->fd = -1;
+  return -1;
+}
+
+/* add a record; it only reaches the file when the buffer is full or flushed */
+int mmLogAppend(struct mmLog *lg, const struct mmLogRecord *rec)
+{
+  if (lg->fd < 0)
+    return -1;
+  lg->buf[lg->n++] = *rec;
+  lg->records++;
+  return lg->n == MM_LOG_BUFFER ? mmLogFlush(lg, 0) : 0;
+}
+
+/* write the buffered records in one go; fsync if @sync@ or if the last one is long ago */
+int mmLogFlush(struct mmLog *lg, int sync)
+{
+  uint64_t now;
+
+  if (lg->fd < 0)
+    return -1;
+  if (lg->n > 0 && writeAll(lg->fd, lg->buf, lg->n * sizeof(lg->buf[0])) < 0)
+    return -1;
+  lg->n = 0;
+
+  now = monoNs();
+  if (sync || now - lg->lastSync >= MM_LOG_SYNC_NS)
+  {
+    lg->lastSync = now;
+    return fsync(lg->fd);
+  }
+  return 0;
+}
+
+int mmLogClose(struct mmLog *lg)
+{
+  int ret;
+
+  if (lg->fd < 0)
+    return -1;
+  ret = mmLogFlush(lg, 1);
+  if (close(lg->fd) != 0)
+    ret = -1;
+  lg->fd = -1;
+  return ret;
+}
+
+/* ======================================================= */
+/* SECTION: reader                                         */
+/* ------------------------------------------------------- */
+
+/* map the log at @path@; a partial record at the end is left out */
+int mmLogMapOpen(struct mmLogMap *lm, const char *path)
+{
+  struct stat st;
+  void *map;
+  int fd;
+
+  memset(lm, 0, sizeof(*lm));
+  if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+    return -1;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct mmLogHeader))
+  {
+    close(fd);
+    return -1;
+  }
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return -1;
+  if (!headerOk((const struct mmLogHeader *)map))
+  {
+    munmap(map, st.st_size);
+    return -1;
+  }
+  // read front to back, once
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+  lm->map = map;
+  lm->mapLen = st.st_size;
+  lm->recs = (const struct mmLogRecord *)((const char *)map + sizeof(struct mmLogHeader));
+  lm->nrecs = (st.st_size - sizeof(struct mmLogHeader)) / sizeof(struct mmLogRecord);
+  return 0;
+}
+
+void mmLogMapClose(struct mmLogMap *lm)
+{
+  if (lm->map != NULL)
+    munmap((void *)lm->map, lm->mapLen);
+  lm->map = NULL;
+}
@@ -0,0 +1,88 @@
+/*
+ * Append-only binary log of games: one fixed-size record when a game starts,
+ * one per round and one when it ends, so a game can be replayed (from its
+ * seed) and analysed offline, e.g. by mm-logstat over millions of games.
+ *
+ * File layout (host byte order, checked via @endian@):
+ *   struct mmLogHeader
+ *   any number of struct mmLogRecord
+ * A crash can leave a partial record at the end; readers ignore it.
+ *
+ * The writer collects records in a buffer, which is written with one write()
+ * when it is full or flushed, e.g. at the end of a game; fsync() happens at
+ * most every MM_LOG_SYNC_NS, and at close. So logging a round is a memcpy and
+ * never waits for the disk.
+ */
+
+#ifndef MM_LOG_H
+#define MM_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MM_LOG_MAGIC "MMLG"
+#define MM_LOG_VERSION 2
+#define MM_LOG_ENDIAN 0x01020304
+
+#define MM_LOG_BUFFER 128 // records
+#define MM_LOG_SYNC_NS (5 * 1000000000ULL)
+
+enum mmLogKind
+{
+  MM_LOG_GAME = 1, // a game starts
+  MM_LOG_ROUND,    // a guess and its feedback
+  MM_LOG_END,      // the game is over
+};
+
+/* flags of a GAME record */
+#define MM_LOG_DISTINCT 1 // no colour repeats (option -p): codes are ranked among those without repeats
+
+struct mmLogHeader
+{
+  char magic[4];
+  uint32_t endian;
+  uint16_t version;
+  uint16_t headerSize;
+  uint16_t recordSize;
+  uint16_t reserved;
+};
+
+struct mmLogRecord
+{
+  uint8_t kind;        // enum mmLogKind
+  uint8_t len, colors; // configuration of the game
+  uint8_t round;       // ROUND: 1-based; END: rounds played
+  uint8_t score;       // ROUND: feedback as countMatches(); END: 1 if the secret was found
+  uint8_t flags;       // GAME: MM_LOG_DISTINCT
+  uint8_t reserved[2];
+  uint32_t code;       // GAME: the secret; ROUND: the guess, the size of the code space if it was invalid
+  uint32_t presses;    // ROUND: button presses for the guess
+  uint64_t seed;       // GAME: seed of the random secret
+  uint64_t ns;         // GAME: wall-clock start; ROUND: time to enter the guess; END: length of the game
+};
+
+struct mmLog
+{
+  int fd;
+  int n; // records in the buffer
+  uint64_t lastSync, records;
+  struct mmLogRecord buf[MM_LOG_BUFFER];
+};
+
+int mmLogOpen(struct mmLog *lg, const char *path);
+int mmLogAppend(struct mmLog *lg, const struct mmLogRecord *rec);
+int mmLogFlush(struct mmLog *lg, int sync);
+int mmLogClose(struct mmLog *lg);
+
+/* a log mapped read-only */
+struct mmLogMap
+{
+  const struct mmLogRecord *recs;
+  size_t nrecs, mapLen;
+  const void *map;
+};
+
+int mmLogMapOpen(struct mmLogMap *lm, const char *path);
+void mmLogMapClose(struct mmLogMap *lm);
+
+#endif
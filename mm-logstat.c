@@ -0,0 +1,99 @@
+/*
+  Aggregate statistics over a game log written by the game (option -l, see
+  mm-log.h): win rate, guesses per won game, and the time taken to enter a
+  guess. The log is mapped and scanned once, so millions of games take seconds.
+
+$ ./master-mind -l games.mml
+$ ./mm-logstat games.mml
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "mm-log.h"
+#include "mm-hist.h"
+
+#define MAX_ROUNDS 16
+
+/* number of codes of a configuration, with or without repeated colours; an
+   invalid guess is logged as this */
+static uint32_t spaceSize(int len, int colors, int distinct)
+{
+  uint32_t size = 1;
+
+  for (int i = 0; i < len; i++)
+    size *= distinct ? colors - i : colors;
+  return size;
+}
+
+int main(int argc, char **argv)
+{
+  struct mmLogMap lm;
+  struct mmHist entry;
+  struct timeval t1, t2;
+  uint64_t games = 0, ended = 0, won = 0, rounds = 0, invalid = 0, wonGuesses = 0, partial = 0;
+  uint64_t byGuesses[MAX_ROUNDS + 1] = {0};
+  int open = 0, distinct = 0;
+
+  if (argc != 2 || strcmp(argv[1], "-h") == 0) {
+    fprintf(stderr, "Usage: %s <game log>\n", argv[0]);
+    exit(argc == 2 ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  if (mmLogMapOpen(&lm, argv[1]) < 0) {
+    fprintf(stderr, "%s: not a game log of this version\n", argv[1]);
+    exit(EXIT_FAILURE);
+  }
+
+  memset(&entry, 0, sizeof(entry));
+  gettimeofday(&t1, NULL);
+  for (size_t i = 0; i < lm.nrecs; i++) {
+    const struct mmLogRecord *r = &lm.recs[i];
+
+    switch (r->kind) {
+    case MM_LOG_GAME:
+      partial += open; // the previous game never ended, e.g. it was interrupted
+      games++;
+      open = 1;
+      distinct = r->flags & MM_LOG_DISTINCT; // rounds are in the space of the game they belong to
+      break;
+    case MM_LOG_ROUND:
+      rounds++;
+      mmHistRecord(&entry, r->ns);
+      if (r->code >= spaceSize(r->len, r->colors, distinct))
+	invalid++;
+      break;
+    case MM_LOG_END:
+      ended++;
+      open = 0;
+      if (r->score) {
+	won++;
+	wonGuesses += r->round;
+	byGuesses[r->round < MAX_ROUNDS ? r->round : MAX_ROUNDS]++;
+      }
+      break;
+    }
+  }
+  gettimeofday(&t2, NULL);
+
+  printf("%llu games, %llu finished, %llu interrupted\n", (unsigned long long)games,
+	 (unsigned long long)ended, (unsigned long long)(partial + open));
+  printf("won %llu (%.2f%%), %.3f guesses per won game\n", (unsigned long long)won,
+	 ended ? 100.0 * won / ended : 0.0, won ? (double)wonGuesses / won : 0.0);
+  for (int g = 1; g <= MAX_ROUNDS; g++)
+    if (byGuesses[g] != 0)
+      printf("  %s%2d guesses: %llu\n", g == MAX_ROUNDS ? ">=" : "  ", g, (unsigned long long)byGuesses[g]);
+  printf("%llu rounds, %llu with an invalid guess; time to enter a guess: p50 %.2f s, p99 %.2f s, max %.2f s\n",
+	 (unsigned long long)rounds, (unsigned long long)invalid, mmHistPercentile(&entry, 500) / 1e9,
+	 mmHistPercentile(&entry, 990) / 1e9, entry.max / 1e9);
+  {
+    double ms = (t2.tv_sec - t1.tv_sec) * 1e3 + (t2.tv_usec - t1.tv_usec) / 1e3;
+
+    fprintf(stderr, "%zu records scanned in %.1f ms (%.0f M records/s)\n", lm.nrecs, ms,
+	    ms > 0 ? lm.nrecs / ms / 1e3 : 0.0);
+  }
+  mmLogMapClose(&lm);
+  return 0;
+}
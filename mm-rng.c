@@ -0,0 +1,118 @@
+/*
+ * Seeding, stream splitting and bounded draws for the xoshiro128** generator
+ * in mm-rng.h.
+ */
+
+#include <stdint.h>
+
+#include "mm-rng.h"
+
+/* expand a 64-bit seed into the state with splitmix64; never all zero */
+void mmRngSeed(struct mmRng *r, uint64_t seed)
+{
+  for (int i = 0; i < 4; i += 2)
+  {
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    r->s[i] = (uint32_t)z;
+    r->s[i + 1] = (uint32_t)(z >> 32);
+  }
+}
+
+/* advance by 2^64 draws, i.e. to the start of the next non-overlapping stream */
+void mmRngJump(struct mmRng *r)
+{
+  static const uint32_t JUMP[] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+  uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+  for (int i = 0; i < 4; i++)
+    for (int b = 0; b < 32; b++)
+    {
+      if (JUMP[i] & (1u << b))
+      {
+        s0 ^= r->s[0];
+        s1 ^= r->s[1];
+        s2 ^= r->s[2];
+        s3 ^= r->s[3];
+      }
+      mmRngNext(r);
+    }
+  r->s[0] = s0;
+  r->s[1] = s1;
+  r->s[2] = s2;
+  r->s[3] = s3;
+}
+
+/* @n@ independent generators, e.g. one per thread; the first one equals @base@ */
+void mmRngStreams(const struct mmRng *base, struct mmRng *streams, int n)
+{
+  for (int i = 0; i < n; i++)
+  {
+    streams[i] = i == 0 ? *base : streams[i - 1];
+    if (i > 0)
+      mmRngJump(&streams[i]);
+  }
+}
+
+/* uniform value in [0, n), without modulo bias (Lemire's multiply-and-reject) */
+uint32_t mmRngBelow(struct mmRng *r, uint32_t n)
+{
+  uint64_t m = (uint64_t)mmRngNext(r) * n;
+  uint32_t low = (uint32_t)m;
+
+  if (low < n)
+  {
+    uint32_t threshold = -n % n;
+
+    while (low < threshold)
+    {
+      m = (uint64_t)mmRngNext(r) * n;
+      low = (uint32_t)m;
+    }
+  }
+  return (uint32_t)(m >> 32);
+}
+
+/* a uniform random code of @len@ pegs with colours 1..colors, from a single draw */
+void mmRngCode(struct mmRng *r, int len, int colors, int *seq)
+{
+  uint32_t size = 1, v;
+
+  for (int i = 0; i < len; i++)
+    size *= colors;
+  v = mmRngBelow(r, size);
+  for (int i = len - 1; i >= 0; i--)
+  {
+    seq[i] = v % colors + 1;
+    v /= colors;
+  }
+}
+
+/* a uniform random code of @len@ pegs with colours 1..colors, no colour twice
+ * (@len@ <= @colors@): the first @len@ steps of a Fisher-Yates shuffle */
+void mmRngCodeDistinct(struct mmRng *r, int len, int colors, int *seq)
+{
+  int deck[32];
+
+  for (int c = 0; c < colors; c++)
+    deck[c] = c + 1;
+  for (int i = 0; i < len; i++)
+  {
+    int j = i + mmRngBelow(r, colors - i), t = deck[i];
+
+    deck[i] = deck[j];
+    deck[j] = t;
+    seq[i] = deck[i];
+  }
+}
+
+/* @n@ uniform random codes, as indices into a code space of @size@ codes
+ * (see mm-solver.h), with or without repeated colours */
+void mmRngCodes(struct mmRng *r, uint32_t size, uint32_t *codes, int n)
+{
+  for (int i = 0; i < n; i++)
+    codes[i] = mmRngBelow(r, size);
+}
@@ -0,0 +1,48 @@
+/*
+ * Small, fast, seedable random number generator (xoshiro128**, by Blackman
+ * and Vigna), with explicit state instead of libc's global, locked rand().
+ * It works on 32-bit words, which suits the ARM core of the Pi. Each thread
+ * of a simulation should own a generator; mmRngJump() gives independent
+ * streams from one seed.
+ */
+
+#ifndef MM_RNG_H
+#define MM_RNG_H
+
+#include <stdint.h>
+
+struct mmRng
+{
+  uint32_t s[4];
+};
+
+void mmRngSeed(struct mmRng *r, uint64_t seed);
+void mmRngJump(struct mmRng *r);
+void mmRngStreams(const struct mmRng *base, struct mmRng *streams, int n);
+uint32_t mmRngBelow(struct mmRng *r, uint32_t n);
+void mmRngCode(struct mmRng *r, int len, int colors, int *seq);
+void mmRngCodeDistinct(struct mmRng *r, int len, int colors, int *seq);
+void mmRngCodes(struct mmRng *r, uint32_t size, uint32_t *codes, int n);
+
+static inline uint32_t mmRngRotl(uint32_t x, int k)
+{
+  return (x << k) | (x >> (32 - k));
+}
+
+/* next 32 random bits */
+static inline uint32_t mmRngNext(struct mmRng *r)
+{
+  uint32_t *s = r->s;
+  uint32_t result = mmRngRotl(s[1] * 5, 7) * 9;
+  uint32_t t = s[1] << 9;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = mmRngRotl(s[3], 11);
+  return result;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Real-time mode and wakeup-jitter measurement, see mm-rt.h.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "mm-rt.h"
+
+/* touch @bytes@ of stack below the caller, so that later calls do not fault;
+ * noinline, so that the array is really on a frame of its own, and written
+ * through a volatile pointer, so that the stores are not optimised away */
+static __attribute__((noinline)) void prefaultStack(size_t bytes)
+{
+  unsigned char buf[bytes];
+  volatile unsigned char *p = buf;
+
+  for (size_t i = 0; i < bytes; i += 4096)
+    p[i] = 0;
+}
+
+/* switch the calling thread to real-time mode; each step is tried even if an
+ * earlier one failed, and failures are reported to @log@; -1 if any failed */
+int mmRtEnter(const struct mmRtConfig *cfg, FILE *log)
+{
+  struct sched_param sp;
+  cpu_set_t set;
+  int ret = 0, cpu = cfg->cpu;
+
+  // locked memory first, so that the stack faulted in below stays resident
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+  {
+    fprintf(log, "rt: mlockall: %s\n", strerror(errno));
+    ret = -1;
+  }
+  prefaultStack(cfg->stackBytes);
+
+  if (cpu < 0)
+    cpu = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (sched_setaffinity(0, sizeof(set), &set) != 0)
+  {
+    fprintf(log, "rt: pinning to CPU %d: %s\n", cpu, strerror(errno));
+    ret = -1;
+  }
+
+  memset(&sp, 0, sizeof(sp));
+  sp.sched_priority = cfg->priority;
+  if (sched_setscheduler(0, SCHED_FIFO, &sp) != 0)
+  {
+    fprintf(log, "rt: SCHED_FIFO priority %d: %s\n", cfg->priority, strerror(errno));
+    ret = -1;
+  }
+  return ret;
+}
+
+/* sleep until @loops@ absolute deadlines @periodNs@ apart, recording how late
+ * each wakeup is into @h@ */
+void mmRtJitter(struct mmHist *h, int loops, uint64_t periodNs)
+{
+  struct timespec next, now;
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  for (int i = 0; i < loops; i++)
+  {
+    uint64_t due;
+
+    next.tv_nsec += periodNs;
+    while (next.tv_nsec >= 1000000000L)
+    {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+      ;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    due = (uint64_t)next.tv_sec * 1000000000ULL + next.tv_nsec;
+    mmHistRecord(h, (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec - due);
+  }
+}
@@ -0,0 +1,35 @@
+/*
+ * Real-time mode for the thread driving the GPIOs: SCHED_FIFO, all memory
+ * locked (mlockall), pinned to one CPU, ideally one isolated from the
+ * scheduler (isolcpus=3 on the kernel command line of a 4-core Pi), and a
+ * stack that is faulted in up front, so that neither preemption nor page
+ * faults stretch the LCD strobes and button samples.
+ *
+ * mmRtJitter() measures how late periodic wakeups are, like cyclictest, so
+ * the mode can be compared against the default scheduler on a loaded system.
+ * Needs root, or CAP_SYS_NICE and CAP_IPC_LOCK.
+ */
+
+#ifndef MM_RT_H
+#define MM_RT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mm-hist.h"
+
+#define MM_RT_PRIORITY 80        // SCHED_FIFO, above threaded interrupt handlers (50)
+#define MM_RT_STACK (256 * 1024) // bytes of stack faulted in
+
+struct mmRtConfig
+{
+  int cpu;           // CPU to pin to, -1 for the last one
+  int priority;      // SCHED_FIFO priority
+  size_t stackBytes; // stack to fault in
+};
+
+int mmRtEnter(const struct mmRtConfig *cfg, FILE *log);
+void mmRtJitter(struct mmHist *h, int loops, uint64_t periodNs);
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Fork-join scheduler with per-core work-stealing deques; see mm-sched.h.
+ * The deques follow Chase and Lev, with the C11 memory orderings of
+ * Le, Pop, Cohen and Zappa Nardelli (PPoPP 2013).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "mm-sched.h"
+
+/* ======================================================= */
+/* SECTION: deques                                         */
+/* ------------------------------------------------------- */
+
+/* owner only; fails if the deque is full */
+static int dequePush(struct mmDeque *dq, struct mmTask *t)
+{
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+  int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+
+  if (b - top >= MM_DEQUE_SIZE)
+    return -1;
+  atomic_store_explicit(&dq->buf[b & (MM_DEQUE_SIZE - 1)], t, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+  return 0;
+}
+
+/* owner only: the newest task */
+static struct mmTask *dequePop(struct mmDeque *dq)
+{
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+  int64_t top;
+  struct mmTask *t = NULL;
+
+  atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  top = atomic_load_explicit(&dq->top, memory_order_relaxed);
+  if (top <= b)
+  {
+    t = atomic_load_explicit(&dq->buf[b & (MM_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (top == b)
+    { // last task: race against thieves
+      if (!atomic_compare_exchange_strong_explicit(&dq->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        t = NULL;
+      atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+    }
+  }
+  else
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+  return t;
+}
+
+/* any thread: the oldest task */
+static struct mmTask *dequeSteal(struct mmDeque *dq)
+{
+  int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+  int64_t b;
+  struct mmTask *t;
+
+  atomic_thread_fence(memory_order_seq_cst);
+  b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+  if (top >= b)
+    return NULL;
+  t = atomic_load_explicit(&dq->buf[top & (MM_DEQUE_SIZE - 1)], memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit(&dq->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+    return NULL;
+  return t;
+}
+
+/* ======================================================= */
+/* SECTION: workers                                        */
+/* ------------------------------------------------------- */
+
+static void runTask(struct mmWorker *w, struct mmTask *t)
+{
+  struct mmJoin *j = t->join;
+
+  t->fn(t, w);
+  w->executed++;
+  atomic_fetch_sub_explicit(&j->pending, 1, memory_order_release);
+}
+
+/* a task from the own deque, or else one stolen from a random victim */
+static struct mmTask *findTask(struct mmWorker *w)
+{
+  struct mmSched *s = w->sched;
+  struct mmTask *t = dequePop(&w->dq);
+
+  if (t != NULL || s->nworkers == 1)
+    return t;
+
+  w->rng ^= w->rng << 13;
+  w->rng ^= w->rng >> 7;
+  w->rng ^= w->rng << 17;
+  for (int i = 0, v = w->rng % s->nworkers; i < s->nworkers; i++, v = (v + 1) % s->nworkers)
+    if (v != w->id && (t = dequeSteal(&s->w[v].dq)) != NULL)
+    {
+      w->stolen++;
+      return t;
+    }
+  return NULL;
+}
+
+static void *workerLoop(void *arg)
+{
+  struct mmWorker *w = (struct mmWorker *)arg;
+
+  while (!atomic_load_explicit(&w->sched->done, memory_order_acquire))
+  {
+    struct mmTask *t = findTask(w);
+
+    if (t != NULL)
+      runTask(w, t);
+    else
+      sched_yield();
+  }
+  return NULL;
+}
+
+/* set up @nworkers@ workers; the calling thread will be worker 0 */
+int mmSchedInit(struct mmSched *s, int nworkers)
+{
+  s->nworkers = nworkers < 1 ? 1 : nworkers;
+  atomic_init(&s->done, 0);
+  if (posix_memalign((void **)&s->w, 64, s->nworkers * sizeof(struct mmWorker)) != 0)
+    return -1;
+  memset(s->w, 0, s->nworkers * sizeof(struct mmWorker));
+  for (int i = 0; i < s->nworkers; i++)
+  {
+    s->w[i].id = i;
+    s->w[i].sched = s;
+    s->w[i].rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+  }
+  return 0;
+}
+
+/* start the threads of workers 1..n-1; set up their local data first */
+int mmSchedStart(struct mmSched *s)
+{
+  for (int i = 1; i < s->nworkers; i++)
+    if (pthread_create(&s->w[i].thread, NULL, workerLoop, &s->w[i]) != 0)
+    {
+      s->nworkers = i;
+      return -1;
+    }
+  return 0;
+}
+
+void mmSchedStop(struct mmSched *s)
+{
+  atomic_store_explicit(&s->done, 1, memory_order_release);
+  for (int i = 1; i < s->nworkers; i++)
+    pthread_join(s->w[i].thread, NULL);
+  free(s->w);
+  s->w = NULL;
+}
+
+/* make @t@ available to other workers; it runs inline if the deque is full */
+void mmSpawn(struct mmWorker *w, struct mmTask *t)
+{
+  atomic_fetch_add_explicit(&t->join->pending, 1, memory_order_relaxed);
+  if (dequePush(&w->dq, t) < 0)
+    runTask(w, t);
+}
+
+/* wait for all children counted by @j@, running other tasks meanwhile */
+void mmWait(struct mmWorker *w, struct mmJoin *j)
+{
+  while (atomic_load_explicit(&j->pending, memory_order_acquire) > 0)
+  {
+    struct mmTask *t = findTask(w);
+
+    if (t != NULL)
+      runTask(w, t);
+    else
+      sched_yield();
+  }
+}
@@ -0,0 +1,68 @@
+/*
+ * A small fork-join scheduler with per-core work-stealing deques, for the
+ * strategy search. A worker pushes and pops tasks at the bottom of its own
+ * deque; idle workers steal the oldest task from the top of another deque.
+ * A worker waiting for its children keeps running tasks instead of blocking,
+ * so deep, uneven task trees keep every core busy.
+ */
+
+#ifndef MM_SCHED_H
+#define MM_SCHED_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define MM_DEQUE_SIZE 4096 // tasks per deque (power of two); when full, tasks run inline
+
+struct mmTask;
+struct mmWorker;
+
+typedef void (*mmTaskFn)(struct mmTask *t, struct mmWorker *w);
+
+/* counts the outstanding children of a parent */
+struct mmJoin
+{
+  _Atomic int pending;
+};
+
+/* a task is owned by its parent, which must wait for it before freeing it */
+struct mmTask
+{
+  mmTaskFn fn;
+  struct mmJoin *join;
+  void *arg;
+};
+
+struct mmDeque
+{
+  _Atomic int64_t top, bottom;
+  struct mmTask *_Atomic buf[MM_DEQUE_SIZE];
+};
+
+struct mmWorker
+{
+  int id;
+  struct mmSched *sched;
+  struct mmDeque dq;
+  pthread_t thread;
+  uint64_t rng;
+  uint64_t executed, stolen; // statistics
+  void *local;               // per-worker data of the client
+};
+
+struct mmSched
+{
+  int nworkers;
+  struct mmWorker *w;
+  _Atomic int done;
+};
+
+int mmSchedInit(struct mmSched *s, int nworkers);
+int mmSchedStart(struct mmSched *s);
+void mmSchedStop(struct mmSched *s);
+
+void mmSpawn(struct mmWorker *w, struct mmTask *t);
+void mmWait(struct mmWorker *w, struct mmJoin *j);
+
+#endif
@@ -0,0 +1,501 @@
+/*
+ * Optimal strategy search by branch-and-bound; see mm-search.h.
+ *
+ * cost(S, d) is the least total number of guesses needed to find every secret
+ * in the candidate set S with at most d more guesses. A guess g splits S into
+ * parts by feedback, and costs |S| + sum of cost(part, d-1) over the parts
+ * other than g itself. Guesses are tried in order of a lower bound on that
+ * sum, and a guess is abandoned as soon as its partial sum reaches the best
+ * cost found so far.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "mm-search.h"
+
+#define SCORE_TAB_MAX (64 * 1024 * 1024)
+#define ARENA_BYTES (16 * 1024 * 1024)
+
+/* per-worker data */
+struct searchLocal
+{
+  char *arena; // LIFO scratch memory for partitions and guess lists
+  size_t top;
+  struct mmBitset keySet;
+  struct mmTTStats tts;
+  uint64_t nodes, guesses;
+};
+
+/* a guess at a node, with the lower bound on its cost */
+struct guessEst
+{
+  uint32_t est;
+  mmCode guess;
+  int isCand;
+};
+
+/* shared state of a node whose guesses run as tasks */
+struct nodeShared
+{
+  _Atomic uint64_t best; // (cost << 32) | guess
+  _Atomic uint32_t lowest;
+};
+
+struct guessTask
+{
+  struct mmTask task;
+  struct mmSearch *se;
+  const mmCode *set;
+  uint32_t n;
+  const struct mmSymmetry *sy;
+  int depth;
+  uint32_t beta;
+  struct guessEst ge;
+  struct nodeShared *shared;
+};
+
+static uint32_t solve(struct mmSearch *se, struct mmWorker *w, const mmCode *set, uint32_t n,
+                      const struct mmSymmetry *sy, int depth, uint32_t beta, mmCode *guess);
+
+/* ======================================================= */
+/* SECTION: helpers                                        */
+/* ------------------------------------------------------- */
+
+static void *arenaAlloc(struct searchLocal *l, size_t bytes)
+{
+  void *p;
+
+  bytes = (bytes + 15) & ~(size_t)15;
+  if (l->top + bytes > ARENA_BYTES)
+  { // a wrong cost would be worse than no result
+    fprintf(stderr, "Search: out of scratch memory\n");
+    exit(EXIT_FAILURE);
+  }
+  p = l->arena + l->top;
+  l->top += bytes;
+  return p;
+}
+
+static inline int scoreIdx(const struct mmSearch *se, mmCode guess, mmCode secret)
+{
+  const struct mmSpace *sp = se->sp;
+
+  if (se->scoreTab != NULL)
+    return se->scoreTab[(size_t)guess * sp->size + secret];
+  if (sp->packed != NULL)
+    return sp->scoreIdx[mmScorePacked(sp, &sp->packed[secret], &sp->packed[guess])];
+  return sp->scoreIdx[mmScoreSeq(sp, se->digits + (size_t)secret * sp->len, se->digits + (size_t)guess * sp->len)];
+}
+
+/* least total cost of @n@ secrets within @depth@ guesses: every node finds at
+ * most one secret and has at most @branch@ children */
+static uint32_t lowerBound(const struct mmSearch *se, uint32_t n, int depth)
+{
+  uint64_t cap = 1, total = 0;
+
+  for (int t = 1; n > 0; t++)
+  {
+    uint32_t k;
+
+    if (t > depth)
+      return MM_INF;
+    k = n < cap ? n : (uint32_t)cap;
+    total += (uint64_t)k * t;
+    n -= k;
+    if (cap < n)
+      cap *= se->branch;
+  }
+  return total < MM_INF ? (uint32_t)total : MM_INF;
+}
+
+static uint64_t setKey(struct searchLocal *l, const mmCode *set, uint32_t n, int depth)
+{
+  uint64_t key;
+
+  for (uint32_t i = 0; i < n; i++)
+    mmBitsetSet(&l->keySet, set[i]);
+  key = mmTTKey(&l->keySet, depth);
+  for (uint32_t i = 0; i < n; i++)
+    l->keySet.w[set[i] >> 6] = 0;
+  return key;
+}
+
+static int cmpEst(const void *a, const void *b)
+{
+  const struct guessEst *x = (const struct guessEst *)a, *y = (const struct guessEst *)b;
+
+  if (x->est != y->est)
+    return x->est < y->est ? -1 : 1;
+  if (x->isCand != y->isCand)
+    return y->isCand - x->isCand;
+  return x->guess < y->guess ? -1 : x->guess > y->guess;
+}
+
+/* ======================================================= */
+/* SECTION: search                                         */
+/* ------------------------------------------------------- */
+
+/* cost of @guess@ at the node (@set@, @depth@); stops once it reaches the bound,
+ * which is @beta@ or, with @shared@ given, the best cost found by other tasks */
+static uint32_t evalGuess(struct mmSearch *se, struct mmWorker *w, const mmCode *set, uint32_t n,
+                          const struct mmSymmetry *sy, int depth, mmCode guess, uint32_t beta,
+                          struct nodeShared *shared)
+{
+  const struct mmSpace *sp = se->sp;
+  struct searchLocal *l = (struct searchLocal *)w->local;
+  uint32_t counts[MM_MAX_SCORES], start[MM_MAX_SCORES], lb[MM_MAX_SCORES];
+  int order[MM_MAX_SCORES], nparts = 0, win = sp->scoreIdx[MM_WIN(sp)];
+  size_t mark = l->top;
+  uint32_t acc = n, bound = beta;
+  struct mmSymmetry csy = *sy;
+  mmCode *parts, dummy;
+
+  l->guesses++;
+  parts = (mmCode *)arenaAlloc(l, n * sizeof(mmCode));
+
+  // partition the candidates by feedback (counting sort)
+  memset(counts, 0, sizeof(counts));
+  for (uint32_t i = 0; i < n; i++)
+    counts[scoreIdx(se, guess, set[i])]++;
+  for (int idx = 0, pos = 0; idx < sp->nscores; idx++)
+  {
+    start[idx] = pos;
+    pos += counts[idx];
+  }
+  for (uint32_t i = 0; i < n; i++)
+    parts[start[scoreIdx(se, guess, set[i])]++] = set[i];
+  for (int idx = 0; idx < sp->nscores; idx++)
+  {
+    start[idx] -= counts[idx];
+    if (counts[idx] == 0 || idx == win)
+      continue;
+    lb[idx] = lowerBound(se, counts[idx], depth - 1);
+    acc = acc + lb[idx] < MM_INF ? acc + lb[idx] : MM_INF;
+    // biggest parts first: they decide most often that the guess is too expensive
+    int k = nparts++;
+    while (k > 0 && counts[order[k - 1]] < counts[idx])
+    {
+      order[k] = order[k - 1];
+      k--;
+    }
+    order[k] = idx;
+  }
+
+  mmSymUpdate(&csy, sp, guess);
+  for (int k = 0; k < nparts && acc < MM_INF; k++)
+  {
+    int idx = order[k];
+    uint32_t c;
+
+    if (shared != NULL)
+    {
+      uint32_t b = (uint32_t)(atomic_load_explicit(&shared->best, memory_order_relaxed) >> 32);
+      bound = b < beta ? b : beta;
+    }
+    if (acc >= bound)
+      break;
+    c = solve(se, w, parts + start[idx], counts[idx], &csy, depth - 1, bound - (acc - lb[idx]), &dummy);
+    acc = acc - lb[idx] + c < MM_INF ? acc - lb[idx] + c : MM_INF;
+  }
+
+  l->top = mark;
+  return acc;
+}
+
+static void guessTaskRun(struct mmTask *t, struct mmWorker *w)
+{
+  struct guessTask *gt = (struct guessTask *)t->arg;
+  struct nodeShared *sh = gt->shared;
+  uint64_t best = atomic_load_explicit(&sh->best, memory_order_relaxed);
+  uint32_t bound = (uint32_t)(best >> 32) < gt->beta ? (uint32_t)(best >> 32) : gt->beta;
+  uint32_t c = gt->ge.est;
+
+  if (c < bound)
+    c = evalGuess(gt->se, w, gt->set, gt->n, gt->sy, gt->depth, gt->ge.guess, gt->beta, sh);
+
+  best = atomic_load_explicit(&sh->best, memory_order_relaxed);
+  if (c < (uint32_t)(best >> 32) && c < gt->beta)
+  {
+    uint64_t mine = ((uint64_t)c << 32) | gt->ge.guess;
+
+    while (mine < best && !atomic_compare_exchange_weak(&sh->best, &best, mine))
+      ;
+  }
+  else
+  {
+    uint32_t low = atomic_load_explicit(&sh->lowest, memory_order_relaxed);
+
+    while (c < low && !atomic_compare_exchange_weak(&sh->lowest, &low, c))
+      ;
+  }
+}
+
+/* cost(set, depth) if it is below @beta@, otherwise a lower bound >= @beta@ */
+static uint32_t solve(struct mmSearch *se, struct mmWorker *w, const mmCode *set, uint32_t n,
+                      const struct mmSymmetry *sy, int depth, uint32_t beta, mmCode *guess)
+{
+  const struct mmSpace *sp = se->sp;
+  struct searchLocal *l = (struct searchLocal *)w->local;
+  struct mmTTResult res;
+  struct guessEst *ges;
+  struct guessTask *tasks = NULL;
+  uint32_t lb, best = beta, lowest = MM_INF, ng = 0;
+  uint32_t counts[MM_MAX_SCORES];
+  size_t mark = l->top;
+  uint64_t key;
+  int win = sp->scoreIdx[MM_WIN(sp)];
+
+  *guess = n > 0 ? set[0] : 0;
+  if (n <= 1)
+    return n;
+  if (depth < 2)
+    return MM_INF;
+  if (n == 2)
+    return 3;
+  if ((lb = lowerBound(se, n, depth)) >= beta)
+    return lb;
+
+  l->nodes++;
+  key = setKey(l, set, n, depth);
+  if (mmTTProbe(&se->tt, key, &res, &l->tts))
+  {
+    if (res.bound == MM_TT_EXACT || res.cost >= beta)
+    {
+      *guess = res.guess;
+      return res.cost;
+    }
+    if (res.cost > lb)
+      lb = res.cost;
+  }
+
+  // lower bounds for all guesses that make progress, one per symmetry class
+  ges = (struct guessEst *)arenaAlloc(l, (size_t)sp->size * sizeof(*ges));
+  for (mmCode g = mmSymNext(sy, sp, 0); g < sp->size; g = mmSymNext(sy, sp, g + 1))
+  {
+    uint32_t est = n;
+
+    memset(counts, 0, sp->nscores * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++)
+      counts[scoreIdx(se, g, set[i])]++;
+    for (int idx = 0; idx < sp->nscores && est < MM_INF; idx++)
+    {
+      if (counts[idx] == n)
+        est = MM_INF; // no information
+      else if (counts[idx] != 0 && idx != win)
+        est += lowerBound(se, counts[idx], depth - 1);
+    }
+    if (est >= MM_INF)
+      continue;
+    ges[ng].est = est;
+    ges[ng].guess = g;
+    ges[ng].isCand = counts[win] != 0;
+    ng++;
+  }
+  qsort(ges, ng, sizeof(*ges), cmpEst);
+
+  // without memory for the tasks, the guesses are evaluated here, one after the other
+  if (n >= MM_PAR_MIN && se->sched.nworkers > 1 && ng > 1 &&
+      (tasks = (struct guessTask *)malloc(ng * sizeof(struct guessTask))) != NULL)
+  { // evaluate the guesses as tasks; the best ones are pushed last, so they run first here
+    struct nodeShared sh;
+    struct mmJoin join;
+
+    atomic_init(&sh.best, ((uint64_t)beta << 32) | 0xFFFFFFFF);
+    atomic_init(&sh.lowest, MM_INF);
+    atomic_init(&join.pending, 0);
+    for (uint32_t i = ng; i-- > 0;)
+    {
+      struct guessTask *gt = &tasks[i];
+
+      gt->task.fn = guessTaskRun;
+      gt->task.join = &join;
+      gt->task.arg = gt;
+      gt->se = se;
+      gt->set = set;
+      gt->n = n;
+      gt->sy = sy;
+      gt->depth = depth;
+      gt->beta = beta;
+      gt->ge = ges[i];
+      gt->shared = &sh;
+      mmSpawn(w, &gt->task);
+    }
+    mmWait(w, &join);
+    free(tasks);
+
+    uint64_t b = atomic_load(&sh.best);
+    best = (uint32_t)(b >> 32);
+    lowest = atomic_load(&sh.lowest);
+    if (best < beta)
+      *guess = (mmCode)b;
+  }
+  else
+  {
+    for (uint32_t i = 0; i < ng; i++)
+    {
+      uint32_t c;
+
+      if (ges[i].est >= best)
+      { // all remaining guesses are at least as expensive
+        if (ges[i].est < lowest)
+          lowest = ges[i].est;
+        break;
+      }
+      c = evalGuess(se, w, set, n, sy, depth, ges[i].guess, best, NULL);
+      if (c < best)
+      {
+        best = c;
+        *guess = ges[i].guess;
+        if (best == lb)
+          break;
+      }
+      else if (c < lowest)
+        lowest = c;
+    }
+  }
+  l->top = mark;
+
+  if (best < beta)
+  {
+    res.guess = *guess;
+    res.cost = best;
+    res.bound = MM_TT_EXACT;
+  }
+  else
+  {
+    best = lowest > lb ? lowest : lb;
+    res.guess = *guess;
+    res.cost = best;
+    res.bound = MM_TT_LOWER;
+  }
+  mmTTStore(&se->tt, key, n, &res, &l->tts);
+  return best;
+}
+
+/* ======================================================= */
+/* SECTION: interface                                      */
+/* ------------------------------------------------------- */
+
+int mmSearchInit(struct mmSearch *se, const struct mmSpace *sp, int maxDepth, size_t ttBytes, int nthreads)
+{
+  memset(se, 0, sizeof(*se));
+  se->sp = sp;
+  se->maxDepth = maxDepth < 1 || maxDepth > MM_MAX_DEPTH ? MM_MAX_DEPTH : maxDepth;
+  se->branch = sp->nscores - 1;
+
+  if ((uint64_t)sp->size * sp->size <= SCORE_TAB_MAX)
+  {
+    unsigned char g[MM_MAX_LEN], s[MM_MAX_LEN];
+
+    if ((se->scoreTab = (unsigned char *)malloc((size_t)sp->size * sp->size)) == NULL)
+      return -1;
+    for (mmCode guess = 0; guess < sp->size; guess++)
+    {
+      mmDecode(sp, guess, g);
+      for (mmCode secret = 0; secret < sp->size; secret++)
+      {
+        if (sp->packed != NULL)
+        {
+          se->scoreTab[(size_t)guess * sp->size + secret] = sp->scoreIdx[mmScore(sp, secret, guess)];
+          continue;
+        }
+        mmDecode(sp, secret, s);
+        se->scoreTab[(size_t)guess * sp->size + secret] = sp->scoreIdx[mmScoreSeq(sp, s, g)];
+      }
+    }
+  }
+  else if (sp->packed == NULL)
+  {
+    if ((se->digits = (unsigned char *)malloc((size_t)sp->size * sp->len)) == NULL)
+      return -1;
+    for (mmCode c = 0; c < sp->size; c++)
+      mmDecode(sp, c, se->digits + (size_t)c * sp->len);
+  }
+
+  if (mmTTInit(&se->tt, ttBytes) < 0 || mmSchedInit(&se->sched, nthreads) < 0)
+    return -1;
+  for (int i = 0; i < se->sched.nworkers; i++)
+  {
+    struct searchLocal *l = (struct searchLocal *)calloc(1, sizeof(*l));
+
+    if (l == NULL || (l->arena = (char *)malloc(ARENA_BYTES)) == NULL || mmBitsetInit(&l->keySet, sp->size) < 0)
+      return -1;
+    se->sched.w[i].local = l;
+  }
+  return mmSchedStart(&se->sched);
+}
+
+/* optimal cost of the candidates @cs@ within @depth@ more guesses, and the guess to make */
+uint32_t mmSearchSolve(struct mmSearch *se, const struct mmCandidates *cs, const struct mmSymmetry *sy,
+                       int depth, mmCode *guess)
+{
+  struct mmWorker *w = &se->sched.w[0];
+  struct searchLocal *l = (struct searchLocal *)w->local;
+  size_t mark = l->top;
+  mmCode *set = (mmCode *)arenaAlloc(l, cs->count * sizeof(mmCode));
+  uint32_t n = 0, cost;
+
+  for (uint32_t i = mmBitsetNext(&cs->set, 0); i < cs->sp->size; i = mmBitsetNext(&cs->set, i + 1))
+    set[n++] = i;
+  cost = solve(se, w, set, n, sy, depth, MM_INF, guess);
+  l->top = mark;
+  return cost;
+}
+
+mmCode mmSearchChoose(const struct mmCandidates *cs, const struct mmSymmetry *sy, int depth, void *ctx)
+{
+  struct mmSearch *se = (struct mmSearch *)ctx;
+  mmCode guess;
+
+  mmSearchSolve(se, cs, sy, se->maxDepth - depth + 1, &guess);
+  return guess;
+}
+
+/* print search statistics, per worker and for the transposition table */
+void mmSearchReport(struct mmSearch *se, FILE *f)
+{
+  struct mmTTStats tts = {0, 0, 0, 0};
+
+  for (int i = 0; i < se->sched.nworkers; i++)
+  {
+    struct mmWorker *w = &se->sched.w[i];
+    struct searchLocal *l = (struct searchLocal *)w->local;
+
+    fprintf(f, "Worker %d: %llu nodes, %llu guesses evaluated, %llu tasks run, %llu stolen\n", i,
+            (unsigned long long)l->nodes, (unsigned long long)l->guesses,
+            (unsigned long long)w->executed, (unsigned long long)w->stolen);
+    tts.probes += l->tts.probes;
+    tts.hits += l->tts.hits;
+    tts.stores += l->tts.stores;
+    tts.replaced += l->tts.replaced;
+  }
+  mmTTReport(&se->tt, &tts, f);
+}
+
+void mmSearchFree(struct mmSearch *se)
+{
+  int n = se->sched.nworkers;
+  void *locals[n];
+
+  for (int i = 0; i < n; i++)
+    locals[i] = se->sched.w[i].local;
+  mmSchedStop(&se->sched);
+  for (int i = 0; i < n; i++)
+  {
+    struct searchLocal *l = (struct searchLocal *)locals[i];
+
+    if (l != NULL)
+    {
+      mmBitsetFree(&l->keySet);
+      free(l->arena);
+      free(l);
+    }
+  }
+  mmTTFree(&se->tt);
+  free(se->scoreTab);
+  free(se->digits);
+}
@@ -0,0 +1,43 @@
+/*
+ * Optimal strategy search: branch-and-bound over guesses, minimising the total
+ * (hence average) number of guesses over all secrets, optionally within a
+ * maximal number of guesses. Subtrees are pruned with lower bounds, solved
+ * subproblems are kept in a transposition table, and large nodes evaluate
+ * their guesses as tasks on the work-stealing scheduler.
+ */
+
+#ifndef MM_SEARCH_H
+#define MM_SEARCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "mm-solver.h"
+#include "mm-ttable.h"
+#include "mm-sched.h"
+
+#define MM_INF 0x3FFFFFFF   // cost of an unsolvable subproblem
+#define MM_MAX_DEPTH 12     // max number of guesses considered
+#define MM_PAR_MIN 64       // spawn tasks at nodes with at least this many candidates
+
+struct mmSearch
+{
+  const struct mmSpace *sp;
+  int maxDepth;
+  int branch;              // number of non-winning feedbacks
+  unsigned char *scoreTab; // dense feedback index of (guess, secret), for small spaces
+  unsigned char *digits;   // decoded codes, if there is no score table
+  struct mmTTable tt;
+  struct mmSched sched;
+};
+
+int mmSearchInit(struct mmSearch *se, const struct mmSpace *sp, int maxDepth, size_t ttBytes, int nthreads);
+uint32_t mmSearchSolve(struct mmSearch *se, const struct mmCandidates *cs, const struct mmSymmetry *sy,
+                       int depth, mmCode *guess);
+void mmSearchReport(struct mmSearch *se, FILE *f);
+void mmSearchFree(struct mmSearch *se);
+
+/* a guess chooser for mmTreeBuildWith() (see mm-book.h); @ctx@ is a struct mmSearch */
+mmCode mmSearchChoose(const struct mmCandidates *cs, const struct mmSymmetry *sy, int depth, void *ctx);
+
+#endif
@@ -0,0 +1,341 @@
+/*
+ * Table-driven and property tests of a matching function, see mm-selftest.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "mm-selftest.h"
+#include "mm-rng.h"
+
+/* known vectors; those that do not fit the configuration are skipped */
+static const struct
+{
+  int len;
+  const char *secret, *guess;
+  int exact, approx;
+} vectors[] = {
+  // the cases from test.sh
+  {3, "123", "321", 1, 2},
+  {3, "121", "313", 0, 1},
+  {3, "132", "321", 0, 3},
+  {3, "123", "112", 1, 1},
+  {3, "112", "233", 0, 1},
+  {3, "111", "333", 0, 0},
+  {3, "331", "223", 0, 1},
+  {3, "331", "232", 1, 0},
+  {3, "232", "331", 1, 0},
+  {3, "312", "312", 3, 0},
+  // duplicates on either side
+  {3, "111", "111", 3, 0},
+  {3, "122", "221", 1, 2},
+  {3, "213", "132", 0, 3},
+  {3, "333", "313", 2, 0},
+  {3, "121", "212", 0, 2},
+  {4, "1122", "2211", 0, 4},
+  {4, "1234", "4321", 0, 4},
+  {4, "1111", "1112", 3, 0},
+  {4, "1123", "3211", 0, 4},
+  {4, "1213", "3131", 0, 3},
+  {4, "6543", "3456", 0, 4},
+  {4, "1122", "1222", 3, 0},
+  {4, "1234", "5612", 0, 2},
+  {4, "1516", "6151", 0, 4},
+  {4, "4444", "1234", 1, 0},
+  {4, "2112", "1221", 0, 4},
+  {4, "3456", "3456", 4, 0},
+  {5, "12345", "54321", 1, 4},
+  {5, "11223", "32211", 1, 4},
+  {5, "12131", "31213", 0, 4},
+  {5, "55555", "12345", 1, 0},
+  {5, "12312", "21321", 1, 4},
+  {5, "78123", "12378", 0, 5},
+};
+
+struct ctx
+{
+  mmMatchFn match;
+  const struct mmSpace *sp;
+  FILE *log;
+  struct mmSelfTestResult *res;
+};
+
+/* call the matching function on copies, since it may overwrite its arguments */
+static int matchCopy(const struct ctx *c, const int *secret, const int *guess)
+{
+  int s[MM_MAX_LEN], g[MM_MAX_LEN];
+
+  memcpy(s, secret, c->sp->len * sizeof(int));
+  memcpy(g, guess, c->sp->len * sizeof(int));
+  return c->match(s, g);
+}
+
+static void showSeqTo(FILE *f, const struct mmSpace *sp, const int *seq)
+{
+  for (int i = 0; i < sp->len; i++)
+    fprintf(f, "%d", seq[i]);
+}
+
+static void check(const struct ctx *c, int ok, const char *what, const int *secret, const int *guess,
+                  int got, int want)
+{
+  if (ok)
+  {
+    c->res->passed++;
+    return;
+  }
+  // report the first few failures only
+  if (++c->res->failed <= 20 && c->log != NULL)
+  {
+    fprintf(c->log, "** %s: ", what);
+    showSeqTo(c->log, c->sp, secret);
+    fprintf(c->log, " ");
+    showSeqTo(c->log, c->sp, guess);
+    fprintf(c->log, ": got %d exact %d approx, expected %d exact %d approx\n", got >> 4, got & 0xF,
+            want >> 4, want & 0xF);
+  }
+}
+
+static void toSeq(const struct mmSpace *sp, mmCode code, int *seq)
+{
+  unsigned char d[MM_MAX_LEN];
+
+  mmDecode(sp, code, d);
+  for (int i = 0; i < sp->len; i++)
+    seq[i] = d[i];
+}
+
+/* compare with the reference scoring on one pair */
+static void crossCheck(const struct ctx *c, mmCode a, mmCode b)
+{
+  int s[MM_MAX_LEN], g[MM_MAX_LEN], got, want = mmScore(c->sp, a, b);
+
+  toSeq(c->sp, a, s);
+  toSeq(c->sp, b, g);
+  got = matchCopy(c, s, g);
+  check(c, got == want, "reference", s, g, got, want);
+}
+
+/* properties that hold for any pair, whatever the right answer is */
+static void properties(const struct ctx *c, struct mmRng *rng, const int *s, const int *g)
+{
+  const struct mmSpace *sp = c->sp;
+  int perm[MM_MAX_COLS + 1], pos[MM_MAX_LEN], ps[MM_MAX_LEN], pg[MM_MAX_LEN];
+  int res = matchCopy(c, s, g), other, same = memcmp(s, g, sp->len * sizeof(int)) == 0;
+
+  other = matchCopy(c, g, s);
+  check(c, other == res, "symmetry", s, g, other, res);
+  check(c, (res >> 4) + (res & 0xF) <= sp->len, "exact+approx <= len", s, g, res, res);
+  check(c, ((res >> 4) == sp->len) == same, "exact == len iff equal", s, g, res, same ? MM_WIN(sp) : 0);
+
+  // renaming the colours (Fisher-Yates) must not change the feedback
+  for (int i = 1; i <= sp->colors; i++)
+    perm[i] = i;
+  for (int i = sp->colors; i > 1; i--)
+  {
+    int j = 1 + mmRngBelow(rng, i), t = perm[i];
+
+    perm[i] = perm[j];
+    perm[j] = t;
+  }
+  for (int i = 0; i < sp->len; i++)
+  {
+    ps[i] = perm[s[i]];
+    pg[i] = perm[g[i]];
+  }
+  other = matchCopy(c, ps, pg);
+  check(c, other == res, "colour permutation", ps, pg, other, res);
+
+  // neither must reordering the positions of both sequences alike
+  for (int i = 0; i < sp->len; i++)
+    pos[i] = i;
+  for (int i = sp->len - 1; i > 0; i--)
+  {
+    int j = mmRngBelow(rng, i + 1), t = pos[i];
+
+    pos[i] = pos[j];
+    pos[j] = t;
+  }
+  for (int i = 0; i < sp->len; i++)
+  {
+    ps[i] = s[pos[i]];
+    pg[i] = g[pos[i]];
+  }
+  other = matchCopy(c, ps, pg);
+  check(c, other == res, "position permutation", ps, pg, other, res);
+}
+
+/* random games in the configuration of @sp@, with repeats or without (@distinct@),
+ * filtering the candidates through an inverted index: after each guess exactly
+ * the candidates that score the feedback must be left */
+static void indexCheck(const struct ctx *c, struct mmRng *rng, int distinct)
+{
+  struct mmSpace space;
+  struct mmIndex ix;
+  struct mmCandidates cs;
+  unsigned char *left;
+
+  if ((distinct ? mmSpaceInitDistinct : mmSpaceInit)(&space, c->sp->len, c->sp->colors) < 0 ||
+      space.size > MM_SELFTEST_INDEX)
+    return;
+  if (mmIndexBuild(&ix, &space, MM_INDEX_MAX_BYTES) < 0)
+    return;
+  if ((left = (unsigned char *)malloc(space.size)) == NULL || mmCandInit(&cs, &space, NULL, &ix) < 0)
+  {
+    free(left);
+    mmIndexFree(&ix);
+    return;
+  }
+
+  for (int game = 0; game < MM_SELFTEST_GAMES; game++)
+  {
+    mmCode secret = mmRngBelow(rng, space.size);
+
+    mmCandReset(&cs);
+    memset(left, 1, space.size);
+    for (int round = 0; round < 2 * space.len && cs.count > 1; round++)
+    {
+      mmCode guess = mmRngBelow(rng, space.size);
+      int fb = mmScore(&space, secret, guess);
+
+      mmCandFilter(&cs, guess, fb);
+      for (mmCode code = 0; code < space.size; code++)
+      {
+        int s[MM_MAX_LEN], g[MM_MAX_LEN], sc = mmScore(&space, code, guess), in = mmBitsetTest(&cs.set, code);
+
+        if (in == (left[code] && sc == fb))
+        {
+          c->res->passed++;
+          left[code] = in;
+          continue;
+        }
+        toSeq(&space, code, s);
+        toSeq(&space, guess, g);
+        check(c, 0, in ? "index filter kept" : "index filter dropped", s, g, sc, fb);
+        left[code] = left[code] && sc == fb;
+      }
+    }
+  }
+  mmCandFree(&cs);
+  free(left);
+  mmIndexFree(&ix);
+}
+
+/* a check that is not about one pair of sequences */
+static void checkThat(const struct ctx *c, int ok, const char *what)
+{
+  if (ok)
+    c->res->passed++;
+  else if (++c->res->failed <= 20 && c->log != NULL)
+    fprintf(c->log, "** %s\n", what);
+}
+
+/* jumped streams must start where the base stream does not get to soon, and
+ * random codes must be in the code space */
+static void rngCheck(const struct ctx *c, uint64_t seed)
+{
+  struct mmRng base, streams[3];
+  uint32_t head[2][4], codes[256], *draws;
+  int seen[64] = {0}, covered = 1;
+
+  mmRngSeed(&base, seed);
+  mmRngStreams(&base, streams, 3);
+  checkThat(c, memcmp(&streams[0], &base, sizeof(base)) == 0, "rng: the first stream is not the base generator");
+  for (int k = 0; k < 2; k++)
+    for (int i = 0; i < 4; i++)
+      head[k][i] = mmRngNext(&streams[k + 1]);
+
+  // the first 4 draws of each jumped stream must not turn up among those of the base
+  if ((draws = (uint32_t *)malloc((MM_SELFTEST_RNG_DRAWS + 3) * sizeof(uint32_t))) != NULL)
+  {
+    int overlap = 0;
+
+    for (int i = 0; i < MM_SELFTEST_RNG_DRAWS + 3; i++)
+      draws[i] = mmRngNext(&base);
+    for (int i = 0; i < MM_SELFTEST_RNG_DRAWS; i++)
+      for (int k = 0; k < 2; k++)
+        overlap |= memcmp(&draws[i], head[k], sizeof(head[k])) == 0;
+    checkThat(c, !overlap, "rng: a jumped stream overlaps the base stream");
+    free(draws);
+  }
+  checkThat(c, memcmp(head[0], head[1], sizeof(head[0])) != 0, "rng: two jumped streams start alike");
+
+  mmRngCodes(&streams[0], c->sp->size, codes, 256);
+  for (int i = 0; i < 256; i++)
+  {
+    checkThat(c, codes[i] < c->sp->size, "rng: a random code is out of the code space");
+    if (codes[i] < 64)
+      seen[codes[i]] = 1;
+  }
+  // a space of a few codes should be covered by 256 draws
+  for (uint32_t i = 0; c->sp->size <= 16 && i < c->sp->size; i++)
+    covered &= seen[i];
+  checkThat(c, covered, "rng: random codes miss part of a small code space");
+}
+
+/* run all tests of @match@ for the configuration @sp@; 0 if all passed */
+int mmSelfTest(mmMatchFn match, const struct mmSpace *sp, uint64_t seed, FILE *log,
+               struct mmSelfTestResult *res)
+{
+  struct ctx c = {match, sp, log, res};
+  struct mmRng rng;
+  struct timeval t1, t2;
+
+  memset(res, 0, sizeof(*res));
+  mmRngSeed(&rng, seed);
+  gettimeofday(&t1, NULL);
+
+  for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++)
+  {
+    int s[MM_MAX_LEN], g[MM_MAX_LEN], fits = vectors[v].len == sp->len, got;
+
+    for (int i = 0; fits && i < sp->len; i++)
+    {
+      s[i] = vectors[v].secret[i] - '0';
+      g[i] = vectors[v].guess[i] - '0';
+      fits = s[i] <= sp->colors && g[i] <= sp->colors;
+    }
+    if (!fits)
+      continue;
+    got = matchCopy(&c, s, g);
+    check(&c, got == ((vectors[v].exact << 4) | vectors[v].approx), "vector", s, g, got,
+          (vectors[v].exact << 4) | vectors[v].approx);
+  }
+
+  if (sp->size <= MM_SELFTEST_EXHAUSTIVE)
+  {
+    for (mmCode a = 0; a < sp->size; a++)
+      for (mmCode b = 0; b < sp->size; b++)
+        crossCheck(&c, a, b);
+  }
+  else
+  {
+    for (int i = 0; i < MM_SELFTEST_RANDOM; i++)
+      crossCheck(&c, mmRngBelow(&rng, sp->size), mmRngBelow(&rng, sp->size));
+  }
+
+  for (int i = 0; i < MM_SELFTEST_RANDOM; i++)
+  {
+    int s[MM_MAX_LEN], g[MM_MAX_LEN];
+
+    mmRngCode(&rng, sp->len, sp->colors, s);
+    // every fourth pair shares most pegs, where matching functions tend to go wrong
+    if (i % 4 == 0)
+      for (int j = 0; j < sp->len; j++)
+        g[j] = mmRngBelow(&rng, 4) ? s[j] : 1 + (int)mmRngBelow(&rng, sp->colors);
+    else
+      mmRngCode(&rng, sp->len, sp->colors, g);
+    properties(&c, &rng, s, g);
+  }
+
+  indexCheck(&c, &rng, 0);
+  indexCheck(&c, &rng, 1);
+  rngCheck(&c, seed);
+
+  gettimeofday(&t2, NULL);
+  res->us = (t2.tv_sec - t1.tv_sec) * 1000000ULL + (t2.tv_usec - t1.tv_usec);
+  return res->failed == 0 ? 0 : -1;
+}
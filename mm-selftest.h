@@ -0,0 +1,41 @@
+/*
+ * In-process tests of a matching function (countMatches, or the Assembler
+ * version): a table of known vectors, a cross-check against the reference
+ * scoring in mm-solver.c, and property checks on random pairs. The index
+ * filter of the candidate sets (mmIndex) is cross-checked against scoring
+ * too, with and without repeated colours, and the random streams and codes
+ * of mm-rng.h are checked for overlap and range. Everything
+ * runs in one process, so thousands of cases take milliseconds.
+ */
+
+#ifndef MM_SELFTEST_H
+#define MM_SELFTEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "mm-solver.h"
+
+/* a matching function: feedback (exact << 4) | approx; it may modify both sequences */
+typedef int (*mmMatchFn)(int *secret, int *guess);
+
+/* pairs checked exhaustively against mmScore() if the space has at most this many codes */
+#define MM_SELFTEST_EXHAUSTIVE 4096
+/* random pairs for the cross-check otherwise, and for the property checks */
+#define MM_SELFTEST_RANDOM 20000
+/* random games for the cross-check of the index filter, in spaces of at most so many codes */
+#define MM_SELFTEST_GAMES 20
+#define MM_SELFTEST_INDEX 65536
+/* draws of the base generator searched for the start of a jumped stream */
+#define MM_SELFTEST_RNG_DRAWS 65536
+
+struct mmSelfTestResult
+{
+  uint64_t passed, failed;
+  uint64_t us; // elapsed time
+};
+
+int mmSelfTest(mmMatchFn match, const struct mmSpace *sp, uint64_t seed, FILE *log,
+               struct mmSelfTestResult *res);
+
+#endif
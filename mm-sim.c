@@ -0,0 +1,93 @@
+/*
+ * Headless simulation of the GPIO block and button, see mm-sim.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mm-clock.h"
+#include "mm-sim.h"
+
+struct mmSim *mmSim = NULL;
+
+static struct mmSim sim;
+
+/* run headless: returns the memory to use as GPIO block, and switches to the virtual clock */
+uint32_t *mmSimInit(const char *script, size_t blockSize)
+{
+  memset(&sim, 0, sizeof(sim));
+  if ((sim.regs = (uint32_t *)calloc(1, blockSize)) == NULL)
+    return NULL;
+  sim.script = script;
+  mmClock = &mmClockVirtual;
+  mmSim = &sim;
+  return sim.regs;
+}
+
+/* an input window starts: take its number of presses from the script */
+void mmSimInput(void)
+{
+  while (*sim.script == ' ')
+    sim.script++;
+  sim.pending = *sim.script >= '0' && *sim.script <= '9' ? *sim.script++ - '0' : 0;
+  sim.windows++;
+  sim.windowAt = mmNow();
+}
+
+/* called for every write to an output pin */
+void mmSimWrite(int pin, int value)
+{
+  uint32_t bit = 1u << (pin % MM_SIM_PINS);
+
+  sim.writes++;
+  if (value && !(sim.levels & bit))
+    sim.rises[pin % MM_SIM_PINS]++;
+  sim.levels = value ? sim.levels | bit : sim.levels & ~bit;
+  if (sim.lcd != NULL)
+    mmLcdEmuPin(sim.lcd, pin, value, mmNow());
+}
+
+/* called before the button on @pin@ is read: it reads as pressed once per scripted
+ * press, and released at the sample after, as a real button would */
+void mmSimSample(int pin)
+{
+  uint32_t bit = 1u << (pin % MM_SIM_PINS);
+
+  if (sim.pending > 0 && !sim.down)
+  {
+    sim.pending--;
+    sim.down = 1;
+    sim.regs[MM_SIM_GPLEV0] |= bit;
+  }
+  else
+  {
+    sim.down = 0;
+    sim.regs[MM_SIM_GPLEV0] &= ~bit;
+  }
+}
+
+/* called before the columns of the keypad (on pins @cols@) are read with row
+ * @row@ driven low: they read high (pulled up), except for the column of the
+ * key of the current window while it is down */
+void mmSimKeyRow(int row, const int *cols, int ncols)
+{
+  uint64_t t = mmNow() - sim.windowAt, down = MM_SIM_KEY_DOWN_MS * MM_NS_PER_MS;
+  int key = sim.pending - 1;
+
+  for (int c = 0; c < ncols; c++)
+    sim.regs[MM_SIM_GPLEV0] |= 1u << (cols[c] % MM_SIM_PINS);
+  if (key < 0 || key / ncols != row || t < down || t >= down + MM_SIM_KEY_HOLD_MS * MM_NS_PER_MS)
+    return;
+  if (t - down < MM_SIM_BOUNCE_NS && (t - down) / MM_SIM_BOUNCE_STEP_NS % 2 == 1)
+    return;
+  sim.regs[MM_SIM_GPLEV0] &= ~(1u << (cols[key % ncols] % MM_SIM_PINS));
+}
+
+void mmSimReport(FILE *f, int greenLED, int redLED)
+{
+  fprintf(f, "Headless game: %d input windows, %llu pin writes, %u green and %u red blinks, %.1f s of virtual time\n",
+          sim.windows, (unsigned long long)sim.writes, sim.rises[greenLED % MM_SIM_PINS],
+          sim.rises[redLED % MM_SIM_PINS], (double)mmNow() / MM_NS_PER_SEC);
+}
@@ -0,0 +1,61 @@
+/*
+ * Headless mode: the game runs against a block of ordinary memory instead of
+ * the GPIO registers mapped from /dev/mem, on the virtual clock (mm-clock.h),
+ * with button presses taken from a script. A whole game, including all LED
+ * and LCD output, then takes milliseconds, for regression tests and load
+ * generation.
+ *
+ * The script has one digit per input window, the number of button presses
+ * in it, e.g. "123" for the guess 1 2 3 in a game of length 3; spaces are
+ * ignored. Once it is used up there are no more presses.
+ *
+ * With the keypad as input (mm-keypad.h), each digit of the script is instead
+ * the key pressed in that window: it goes down MM_SIM_KEY_DOWN_MS after the
+ * window starts, bouncing for the first MM_SIM_BOUNCE_NS, and is held for
+ * MM_SIM_KEY_HOLD_MS; 0 is no key.
+ *
+ * If an LCD emulator is attached (mm-lcdemu.h), every pin write is passed on
+ * to it with the time of the virtual clock.
+ */
+
+#ifndef MM_SIM_H
+#define MM_SIM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "mm-lcdemu.h"
+
+#define MM_SIM_PINS 32 // pins in GPIO bank 0, the only one the game uses
+#define MM_SIM_GPLEV0 (0x34 / 4)
+
+#define MM_SIM_KEY_DOWN_MS 100
+#define MM_SIM_KEY_HOLD_MS 200
+#define MM_SIM_BOUNCE_NS 3000000 // contact bounce of a key going down
+#define MM_SIM_BOUNCE_STEP_NS 700000
+
+struct mmSim
+{
+  uint32_t *regs;     // stands in for the mapped GPIO block
+  const char *script; // remaining button presses
+  int pending;        // presses left in the current input window
+  int down;           // the button read as pressed at the last sample
+  int windows;        // input windows so far
+  uint64_t windowAt;  // start of the current one
+  uint32_t levels;    // output levels, as last written
+  uint64_t writes;
+  uint32_t rises[MM_SIM_PINS]; // low-to-high transitions per pin, e.g. LED blinks
+  struct mmLcdEmu *lcd;        // display attached to the pins, if any
+};
+
+/* the simulation, if running headless */
+extern struct mmSim *mmSim;
+
+uint32_t *mmSimInit(const char *script, size_t blockSize);
+void mmSimInput(void);
+void mmSimWrite(int pin, int value);
+void mmSimSample(int pin);
+void mmSimKeyRow(int row, const int *cols, int ncols);
+void mmSimReport(FILE *f, int greenLED, int redLED);
+
+#endif
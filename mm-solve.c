@@ -0,0 +1,322 @@
+/*
+  A host tool to compute MasterMind strategies offline, e.g. the opening book
+  that the game maps at startup (see mm-book.h).
+
+$ make book LEN=4 COLS=6
+  or
+$ ./mm-solve -l 4 -c 6 -o book-4x6.mmb
+
+  With -O it computes the optimal strategy, i.e. the one with the least average
+  number of guesses (optionally within -d guesses), on all cores:
+$ ./mm-solve -O -l 4 -c 6 -o book-4x6-opt.mmb
+
+  With -C it also writes the strategy as C code, to be compiled into the game
+  (see mm-gentree.h); make gen does this and checks the code against the book:
+$ ./mm-solve -l 4 -c 6 -o mm-gentree.mmb -C mm-gentree.c
+
+  With -S it plays -n random secrets in spaces too big for a book, keeping the
+  candidates in compressed containers under a cap of -M megabytes (see mm-stream.h):
+$ ./mm-solve -S -l 8 -c 10 -n 3 -M 64
+
+  With -p all of these are for the variant without repeated colours, in which
+  codes are scored by a few bit operations (see mmScorePacked()):
+$ ./mm-solve -p -l 4 -c 10 -o book-4x10-p.mmb
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "mm-solver.h"
+#include "mm-book.h"
+#include "mm-search.h"
+#include "mm-stream.h"
+#include "mm-rng.h"
+
+/* scorings per guess-evaluation pass in streaming mode, bounding the time of a round */
+#define STREAM_BUDGET 400000000ULL
+
+/* published optima, total number of guesses over all secrets; depth 0 means no limit */
+static const struct { int len, colors, depth; uint32_t total; } optima[] = {
+  {4, 6, 0, 5625}, // Koyama and Lai, 1993
+  {4, 6, 5, 5626},
+};
+
+/* play every secret against the book, checking that each one is found */
+static int checkBook(const struct mmSpace *sp, const struct mmBook *bk)
+{
+  uint64_t total = 0;
+
+  for (mmCode secret = 0; secret < sp->size; secret++)
+  {
+    uint32_t node = 0;
+    int turn;
+
+    for (turn = 1; turn <= bk->hdr->maxDepth; turn++)
+    {
+      mmCode guess = mmBookGuess(bk, node);
+      int score;
+
+      if (guess == MM_BOOK_BAD)
+        return -1;
+      if ((score = mmScore(sp, secret, guess)) == MM_WIN(sp))
+        break;
+      if ((node = mmBookChild(bk, node, sp->scoreIdx[score])) == 0 || node == MM_BOOK_BAD)
+        return -1;
+    }
+    if (turn > bk->hdr->maxDepth)
+      return -1;
+    total += turn;
+  }
+  return total == bk->hdr->totalGuesses ? 0 : -1;
+}
+
+static double msSince(const struct timeval *t1)
+{
+  struct timeval t2;
+
+  gettimeofday(&t2, NULL);
+  return (t2.tv_sec - t1->tv_sec) * 1e3 + (t2.tv_usec - t1->tv_usec) / 1e3;
+}
+
+/* play @games@ random secrets with streamed candidate sets, reporting memory and throughput */
+static int streamGames(const struct mmSpace *sp, size_t capBytes, int games, int maxGuesses,
+		       uint64_t seed, int verbose)
+{
+  struct mmStream st;
+  struct mmRng rng, *streams;
+  struct timeval t1;
+  uint64_t total = 0;
+  int worst = 0;
+  mmCode *secrets;
+
+  // all secrets from the first stream, then one stream per game for its guesses,
+  // so that a game plays the same whatever the other games drew
+  mmRngSeed(&rng, seed);
+  streams = (struct mmRng *)malloc((games + 1) * sizeof(*streams));
+  secrets = (mmCode *)malloc(games * sizeof(*secrets));
+  if (streams == NULL || secrets == NULL) {
+    free(streams);
+    free(secrets);
+    return -1;
+  }
+  mmRngStreams(&rng, streams, games + 1);
+  mmRngCodes(&streams[0], sp->size, secrets, games);
+
+  gettimeofday(&t1, NULL);
+  if (mmStreamInit(&st, sp, capBytes) < 0) {
+    fprintf(stderr, "Cannot set up the candidate set within %zu bytes\n", capBytes);
+    free(streams);
+    free(secrets);
+    return -1;
+  }
+  for (int game = 0; game < games; game++) {
+    mmCode secret = secrets[game], guess;
+    int turn;
+
+    if (game > 0 && mmStreamReset(&st) < 0)
+      break;
+    for (turn = 1; turn <= 4 * sp->len + sp->colors; turn++) {
+      struct timeval t;
+      int score;
+
+      gettimeofday(&t, NULL);
+      guess = mmStreamChoose(&st, &streams[game + 1], maxGuesses, STREAM_BUDGET);
+      score = mmScore(sp, secret, guess);
+      if (verbose)
+	fprintf(stderr, "game %d turn %d: %llu candidates, guess %u, feedback %d exact %d approx",
+		game + 1, turn, (unsigned long long)st.count, guess, score >> 4, score & 0xF);
+      if (score == MM_WIN(sp)) {
+	if (verbose)
+	  fprintf(stderr, " (%.1f ms)\n", msSince(&t));
+	break;
+      }
+      if (mmStreamFilter(&st, guess, score) < 0) {
+	fprintf(stderr, "\n** Memory cap of %zu bytes exceeded\n", capBytes);
+	mmStreamReport(&st, stderr);
+	mmStreamFree(&st);
+	free(streams);
+	free(secrets);
+	return -1;
+      }
+      if (verbose) {
+	fprintf(stderr, " (%.1f ms)\n  ", msSince(&t));
+	mmStreamReport(&st, stderr);
+      }
+    }
+    total += turn;
+    if (turn > worst)
+      worst = turn;
+  }
+
+  {
+    double ms = msSince(&t1);
+
+    fprintf(stderr, "Streamed %dx%d%s: %d games, %.3f guesses on average, at most %d (%.0f ms)\n",
+	    sp->len, sp->colors, sp->distinct ? " without repeats" : "", games, (double)total / games, worst, ms);
+    fprintf(stderr, "%llu scorings, %.1f M/s; ", (unsigned long long)st.scorings, st.scorings / ms / 1e3);
+    mmStreamReport(&st, stderr);
+  }
+  mmStreamFree(&st);
+  free(streams);
+  free(secrets);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  struct mmSpace sp;
+  struct mmMaskTable mt;
+  struct mmTree tr;
+  struct mmBook bk;
+  struct mmSearch se;
+  struct timeval t1, t2;
+  int len = 3, colors = 3, verbose = 0, optimal = 0, depth = 0, threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int stream = 0, games = 1, maxGuesses = 16, distinct = 0;
+  size_t ttMB = 64, capMB = 64;
+  uint64_t seed = 1701;
+  char *out = NULL, *outC = NULL;
+
+  { // see: man 3 getopt
+    int opt;
+    while ((opt = getopt(argc, argv, "hvOSpl:c:o:C:d:j:m:M:n:g:s:")) != -1) {
+      switch (opt) {
+      case 'v':
+	verbose = 1;
+	break;
+      case 'l':
+	len = atoi(optarg);
+	break;
+      case 'c':
+	colors = atoi(optarg);
+	break;
+      case 'o':
+	out = optarg;
+	break;
+      case 'C':
+	outC = optarg;
+	break;
+      case 'O':
+	optimal = 1;
+	break;
+      case 'p':
+	distinct = 1;
+	break;
+      case 'd':
+	depth = atoi(optarg);
+	break;
+      case 'j':
+	threads = atoi(optarg);
+	break;
+      case 'm':
+	ttMB = atoi(optarg);
+	break;
+      case 'S':
+	stream = 1;
+	break;
+      case 'M':
+	capMB = atoi(optarg);
+	break;
+      case 'n':
+	games = atoi(optarg);
+	break;
+      case 'g':
+	maxGuesses = atoi(optarg);
+	break;
+      case 's':
+	seed = strtoull(optarg, NULL, 0);
+	break;
+      case 'h':
+      default:
+	fprintf(stderr, "Usage: %s [-h] [-v] [-p] [-l <length>] [-c <colours>] [-o <book file>] [-C <C file>]\n"
+		"       [-O [-d <max guesses>] [-j <threads>] [-m <transposition table MB>]]\n"
+		"       [-S [-n <games>] [-M <memory cap MB>] [-g <guesses per round>] [-s <seed>]]\n", argv[0]);
+	exit(opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+      }
+    }
+  }
+
+  if ((distinct ? mmSpaceInitDistinct : mmSpaceInit)(&sp, len, colors) < 0) {
+    fprintf(stderr, "Unsupported configuration %dx%d%s (max %dx%d)\n", len, colors, distinct ? " without repeats" : "",
+	    MM_MAX_LEN, MM_MAX_COLS);
+    exit(EXIT_FAILURE);
+  }
+  if (stream)
+    exit(streamGames(&sp, capMB << 20, games > 0 ? games : 1, maxGuesses, seed, verbose) < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+  if (out == NULL && outC == NULL && !optimal) {
+    fprintf(stderr, "No output file given (option -o or -C)\n");
+    exit(EXIT_FAILURE);
+  }
+
+  gettimeofday(&t1, NULL);
+  // the stream keeps under its own cap and packs codes as it goes; the rest score from a table
+  if (distinct && mmSpacePack(&sp, MM_PACK_MAX_BYTES) < 0 && verbose)
+    fprintf(stderr, "Code space too big for a packed table, decoding codes instead\n");
+  if (mmMaskTableBuild(&mt, &sp, MM_MASK_MAX_BYTES) < 0 && verbose)
+    fprintf(stderr, "Code space too big for a mask table, scoring candidates instead\n");
+  if (optimal) {
+    if (mmSearchInit(&se, &sp, depth, ttMB << 20, threads) < 0) {
+      fprintf(stderr, "Failed to set up the search\n");
+      exit(EXIT_FAILURE);
+    }
+    if (mmTreeBuildWith(&tr, &sp, &mt, mmSearchChoose, &se) < 0) {
+      fprintf(stderr, "Failed to build the optimal tree\n");
+      exit(EXIT_FAILURE);
+    }
+  } else if (mmTreeBuild(&tr, &sp, &mt) < 0) {
+    fprintf(stderr, "Failed to build the tree\n");
+    exit(EXIT_FAILURE);
+  }
+  gettimeofday(&t2, NULL);
+
+  fprintf(stderr, "%s for %dx%d%s: %u nodes, %llu guesses in total, %.4f on average, at most %d (%ld ms)\n",
+	  optimal ? "Optimal tree" : "Tree", len, colors, distinct ? " without repeats" : "", tr.nnodes, (unsigned long long)tr.totalGuesses,
+	  (double)tr.totalGuesses / sp.size, tr.maxDepth,
+	  (t2.tv_sec - t1.tv_sec) * 1000L + (t2.tv_usec - t1.tv_usec) / 1000);
+
+  if (optimal) {
+    int ret = 0;
+
+    if (verbose)
+      mmSearchReport(&se, stderr);
+    mmSearchFree(&se);
+    // built-in check against the published optimum, where there is one
+    for (size_t i = 0; i < sizeof(optima) / sizeof(optima[0]); i++)
+      if (!distinct && optima[i].len == len && optima[i].colors == colors && optima[i].depth == depth) {
+	if (tr.totalGuesses == optima[i].total) {
+	  fprintf(stderr, "__ matches the published optimum of %u\n", optima[i].total);
+	} else {
+	  fprintf(stderr, "** WRONG: the published optimum is %u\n", optima[i].total);
+	  ret = 1;
+	}
+      }
+    if (ret || (out == NULL && outC == NULL))
+      exit(ret);
+  }
+
+  if (outC != NULL && mmTreeWriteC(&tr, outC) < 0) {
+    fprintf(stderr, "Failed to write C code %s\n", outC);
+    exit(EXIT_FAILURE);
+  }
+  if (out == NULL)
+    return 0;
+  if (mmTreeWrite(&tr, out) < 0) {
+    fprintf(stderr, "Failed to write book %s\n", out);
+    exit(EXIT_FAILURE);
+  }
+  mmTreeFree(&tr);
+  mmMaskTableFree(&mt);
+
+  if (mmBookOpen(&bk, out) < 0 || checkBook(&sp, &bk) < 0) {
+    fprintf(stderr, "** Book %s does not solve all secrets\n", out);
+    exit(EXIT_FAILURE);
+  }
+  if (verbose)
+    fprintf(stderr, "Book %s checked against all %u secrets (%zu bytes)\n", out, sp.size, bk.mapLen);
+  mmBookClose(&bk);
+  mmSpaceFree(&sp);
+  return 0;
+}
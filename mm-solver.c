@@ -0,0 +1,748 @@
+/*
+ * Code space, scoring and candidate-set data structures for MasterMind.
+ * See mm-solver.h for the representation of codes and feedback.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mm-solver.h"
+
+/* ======================================================= */
+/* SECTION: code space                                     */
+/* ------------------------------------------------------- */
+
+/* the feedback values possible in @sp@, indexed densely */
+static void initScores(struct mmSpace *sp)
+{
+  // every (exact, approximate) pair with exact + approximate <= len is possible,
+  // except len-1 exact and 1 approximate; without repeats, two codes have at
+  // least 2*len - colors colours in common
+  memset(sp->scoreIdx, MM_NO_SCORE, sizeof(sp->scoreIdx));
+  sp->nscores = 0;
+  for (int e = 0; e <= sp->len; e++)
+    for (int a = 0; e + a <= sp->len; a++)
+    {
+      if ((e == sp->len - 1 && a == 1) || (sp->distinct && e + a < 2 * sp->len - sp->colors))
+        continue;
+      sp->scoreIdx[(e << 4) | a] = sp->nscores;
+      sp->scoreVal[sp->nscores++] = (e << 4) | a;
+    }
+}
+
+/* set up the code space for sequences of @len@ pegs in @colors@ colours */
+int mmSpaceInit(struct mmSpace *sp, int len, int colors)
+{
+  uint64_t size = 1;
+
+  if (len < 1 || len > MM_MAX_LEN || colors < 1 || colors > MM_MAX_COLS)
+    return -1;
+
+  sp->len = len;
+  sp->colors = colors;
+  sp->distinct = 0;
+  sp->packed = NULL;
+  for (int i = len - 1; i >= 0; i--)
+  {
+    sp->pow[i] = (uint32_t)size;
+    size *= colors;
+  }
+  sp->size = (uint32_t)size;
+  initScores(sp);
+  return 0;
+}
+
+/* the @d@-th (from 0) lowest colour in the set @avail@ */
+static inline int nthColour(uint32_t avail, int d)
+{
+  while (d-- > 0)
+    avail &= avail - 1;
+  return __builtin_ctz(avail);
+}
+
+/* index of @seq@ among the codes without repeats: each peg is a digit, the
+ * number of colours below it not used further left; sp->size if a colour repeats */
+static mmCode rankDistinct(const struct mmSpace *sp, const unsigned char *seq)
+{
+  uint32_t used = 0;
+  mmCode code = 0;
+
+  for (int i = 0; i < sp->len; i++)
+  {
+    if (used & (1u << seq[i]))
+      return sp->size;
+    code += (seq[i] - 1 - __builtin_popcount(used & ((1u << seq[i]) - 1))) * sp->pow[i];
+    used |= 1u << seq[i];
+  }
+  return code;
+}
+
+static void unrankDistinct(const struct mmSpace *sp, mmCode code, unsigned char *seq)
+{
+  uint32_t avail = ((1u << sp->colors) - 1) << 1;
+
+  for (int i = 0; i < sp->len; i++)
+  {
+    seq[i] = nthColour(avail, code / sp->pow[i]);
+    code %= sp->pow[i];
+    avail &= ~(1u << seq[i]);
+  }
+}
+
+/* set up the space of sequences of @len@ pegs in @colors@ colours, no colour
+ * twice in a sequence; see mmSpacePack() for fast scoring */
+int mmSpaceInitDistinct(struct mmSpace *sp, int len, int colors)
+{
+  uint32_t size = 1;
+
+  if (len < 1 || len > MM_MAX_LEN || colors < len || colors > MM_MAX_COLS)
+    return -1;
+
+  sp->len = len;
+  sp->colors = colors;
+  sp->distinct = 1;
+  sp->packed = NULL;
+  // place value of position i: the arrangements of the positions after it
+  for (int i = len - 1; i >= 0; i--)
+  {
+    sp->pow[i] = size;
+    size *= colors - i;
+  }
+  sp->size = size;
+  initScores(sp);
+  return 0;
+}
+
+/* keep all codes of a space without repeats packed (8 bytes per code), so that
+ * mmScore() and the candidate sets score without decoding; fails, leaving the
+ * space as it is, if that needs more than @maxBytes@ */
+int mmSpacePack(struct mmSpace *sp, size_t maxBytes)
+{
+  if (!sp->distinct || (uint64_t)sp->size * sizeof(*sp->packed) > maxBytes)
+    return -1;
+  if (sp->packed != NULL)
+    return 0;
+  if ((sp->packed = (struct mmPacked *)malloc((size_t)sp->size * sizeof(*sp->packed))) == NULL)
+    return -1;
+  for (mmCode code = 0; code < sp->size; code++)
+  {
+    unsigned char seq[MM_MAX_LEN];
+
+    unrankDistinct(sp, code, seq);
+    mmPackSeq(sp, seq, &sp->packed[code]);
+  }
+  return 0;
+}
+
+void mmSpaceFree(struct mmSpace *sp)
+{
+  free(sp->packed);
+  sp->packed = NULL;
+}
+
+/* turn a code into a sequence of pegs, with colours 1..colors */
+void mmDecode(const struct mmSpace *sp, mmCode code, unsigned char *seq)
+{
+  if (sp->distinct)
+  {
+    unrankDistinct(sp, code, seq);
+    return;
+  }
+  for (int i = sp->len - 1; i >= 0; i--)
+  {
+    seq[i] = code % sp->colors + 1;
+    code /= sp->colors;
+  }
+}
+
+/* turn a sequence of pegs, with colours 1..colors, into a code; without
+ * repeats, a sequence repeating a colour gives sp->size */
+mmCode mmEncode(const struct mmSpace *sp, const int *seq)
+{
+  mmCode code = 0;
+
+  if (sp->distinct)
+  {
+    unsigned char s[MM_MAX_LEN];
+
+    for (int i = 0; i < sp->len; i++)
+      s[i] = seq[i];
+    return rankDistinct(sp, s);
+  }
+  for (int i = 0; i < sp->len; i++)
+    code = code * sp->colors + (seq[i] - 1);
+  return code;
+}
+
+/* feedback for @guess@ against @secret@, encoded as in countMatches() */
+int mmScoreSeq(const struct mmSpace *sp, const unsigned char *secret, const unsigned char *guess)
+{
+  unsigned char cs[MM_MAX_COLS + 1] = {0}, cg[MM_MAX_COLS + 1] = {0};
+  int exact = 0, common = 0;
+
+  for (int i = 0; i < sp->len; i++)
+  {
+    if (secret[i] == guess[i])
+      exact++;
+    else
+    {
+      cs[secret[i]]++;
+      cg[guess[i]]++;
+    }
+  }
+  for (int c = 1; c <= sp->colors; c++)
+    common += cs[c] < cg[c] ? cs[c] : cg[c];
+
+  return (exact << 4) | common;
+}
+
+int mmScore(const struct mmSpace *sp, mmCode secret, mmCode guess)
+{
+  unsigned char s[MM_MAX_LEN], g[MM_MAX_LEN];
+
+  if (sp->packed != NULL)
+    return mmScorePacked(sp, &sp->packed[secret], &sp->packed[guess]);
+  mmDecode(sp, secret, s);
+  mmDecode(sp, guess, g);
+  return mmScoreSeq(sp, s, g);
+}
+
+/* ======================================================= */
+/* SECTION: bitsets                                        */
+/* ------------------------------------------------------- */
+
+int mmBitsetInit(struct mmBitset *bs, uint32_t nbits)
+{
+  bs->nbits = nbits;
+  bs->nwords = (nbits + 63) / 64;
+  bs->w = (uint64_t *)calloc(bs->nwords ? bs->nwords : 1, sizeof(uint64_t));
+  return bs->w == NULL ? -1 : 0;
+}
+
+void mmBitsetFree(struct mmBitset *bs)
+{
+  free(bs->w);
+  bs->w = NULL;
+}
+
+/* set all bits; the unused bits of the last word stay clear */
+void mmBitsetFill(struct mmBitset *bs)
+{
+  memset(bs->w, 0xFF, bs->nwords * sizeof(uint64_t));
+  if (bs->nbits & 63)
+    bs->w[bs->nwords - 1] = ((uint64_t)1 << (bs->nbits & 63)) - 1;
+}
+
+uint32_t mmBitsetCount(const struct mmBitset *bs)
+{
+  uint32_t n = 0;
+
+  for (uint32_t k = 0; k < bs->nwords; k++)
+    n += __builtin_popcountll(bs->w[k]);
+  return n;
+}
+
+/* intersect with @mask@ (of the same size), returning the new number of members */
+uint32_t mmBitsetAnd(struct mmBitset *bs, const uint64_t *mask)
+{
+  uint32_t n = 0;
+
+  for (uint32_t k = 0; k < bs->nwords; k++)
+  {
+    bs->w[k] &= mask[k];
+    n += __builtin_popcountll(bs->w[k]);
+  }
+  return n;
+}
+
+/* ======================================================= */
+/* SECTION: candidate sets                                 */
+/* ------------------------------------------------------- */
+
+/* precompute the (guess, score) masks; fails if they need more than @maxBytes@ */
+int mmMaskTableBuild(struct mmMaskTable *mt, const struct mmSpace *sp, size_t maxBytes)
+{
+  unsigned char g[MM_MAX_LEN], s[MM_MAX_LEN];
+  size_t bytes;
+
+  mt->sp = sp;
+  mt->nwords = (sp->size + 63) / 64;
+  mt->masks = NULL;
+
+  bytes = (size_t)sp->size * sp->nscores * mt->nwords * sizeof(uint64_t);
+  if ((uint64_t)sp->size * sp->nscores * mt->nwords > maxBytes / sizeof(uint64_t))
+    return -1;
+
+  mt->masks = (uint64_t *)calloc(1, bytes);
+  if (mt->masks == NULL)
+    return -1;
+
+  for (mmCode guess = 0; guess < sp->size; guess++)
+  {
+    uint64_t *row = mt->masks + (size_t)guess * sp->nscores * mt->nwords;
+
+    mmDecode(sp, guess, g);
+    for (mmCode secret = 0; secret < sp->size; secret++)
+    {
+      int idx;
+
+      if (sp->packed != NULL)
+        idx = sp->scoreIdx[mmScorePacked(sp, &sp->packed[secret], &sp->packed[guess])];
+      else
+      {
+        mmDecode(sp, secret, s);
+        idx = sp->scoreIdx[mmScoreSeq(sp, s, g)];
+      }
+      row[(size_t)idx * mt->nwords + (secret >> 6)] |= (uint64_t)1 << (secret & 63);
+    }
+  }
+  return 0;
+}
+
+void mmMaskTableFree(struct mmMaskTable *mt)
+{
+  free(mt->masks);
+  mt->masks = NULL;
+}
+
+/* build the inverted index; fails if it needs more than @maxBytes@ */
+int mmIndexBuild(struct mmIndex *ix, const struct mmSpace *sp, size_t maxBytes)
+{
+  unsigned char s[MM_MAX_LEN];
+  size_t n = (size_t)2 * sp->len * sp->colors;
+
+  ix->sp = sp;
+  ix->nwords = (sp->size + 63) / 64;
+  ix->pos = ix->atLeast = NULL;
+  if ((uint64_t)n * ix->nwords > maxBytes / sizeof(uint64_t))
+    return -1;
+  if ((ix->pos = (uint64_t *)calloc(n * ix->nwords, sizeof(uint64_t))) == NULL)
+    return -1;
+  ix->atLeast = ix->pos + n / 2 * ix->nwords;
+
+  for (mmCode code = 0; code < sp->size; code++)
+  {
+    unsigned char cnt[MM_MAX_COLS + 1] = {0};
+    uint64_t bit = (uint64_t)1 << (code & 63);
+
+    mmDecode(sp, code, s);
+    for (int i = 0; i < sp->len; i++)
+    {
+      ((uint64_t *)mmIndexPos(ix, i, s[i]))[code >> 6] |= bit;
+      ((uint64_t *)mmIndexAtLeast(ix, s[i], ++cnt[s[i]]))[code >> 6] |= bit;
+    }
+  }
+  // a code with k pegs of a colour also has at least 1..k-1 of them
+  for (int c = 1; c <= sp->colors; c++)
+    for (int k = sp->len - 1; k >= 1; k--)
+    {
+      uint64_t *lo = (uint64_t *)mmIndexAtLeast(ix, c, k);
+      const uint64_t *hi = mmIndexAtLeast(ix, c, k + 1);
+
+      for (uint32_t w = 0; w < ix->nwords; w++)
+        lo[w] |= hi[w];
+    }
+  return 0;
+}
+
+void mmIndexFree(struct mmIndex *ix)
+{
+  free(ix->pos);
+  ix->pos = ix->atLeast = NULL;
+}
+
+/* start with all codes as candidates; @mt@ and @ix@ may be NULL */
+int mmCandInit(struct mmCandidates *cs, const struct mmSpace *sp, const struct mmMaskTable *mt,
+               const struct mmIndex *ix)
+{
+  cs->sp = sp;
+  cs->mt = (mt != NULL && mt->masks != NULL) ? mt : NULL;
+  cs->ix = (ix != NULL && ix->pos != NULL) ? ix : NULL;
+  if (mmBitsetInit(&cs->set, sp->size) < 0)
+    return -1;
+  mmCandReset(cs);
+  return 0;
+}
+
+void mmCandReset(struct mmCandidates *cs)
+{
+  mmBitsetFill(&cs->set);
+  cs->count = cs->sp->size;
+}
+
+/* add the bits of @x@ to the bit-sliced counters @sum@ */
+static inline void sliceAdd(uint64_t *sum, uint64_t x)
+{
+  for (int b = 0; x != 0 && b < 4; b++)
+  {
+    uint64_t t = sum[b] & x;
+
+    sum[b] ^= x;
+    x = t;
+  }
+}
+
+/* the bits where the bit-sliced counters @sum@ equal @n@ */
+static inline uint64_t sliceEq(const uint64_t *sum, int n)
+{
+  uint64_t eq = ~(uint64_t)0;
+
+  for (int b = 0; b < 4; b++)
+    eq &= n >> b & 1 ? sum[b] : ~sum[b];
+  return eq;
+}
+
+/* keep the candidates that give feedback @score@ to the guess @g@, without
+ * scoring any: for each word of candidates, the exact matches are counted by
+ * adding up the position bitsets of the guess, and the colours in common by
+ * adding up, for the j-th peg of colour c in the guess, the codes with at least
+ * j pegs of c (as sum min(guess count, secret count) over the colours) */
+static void indexFilter(struct mmCandidates *cs, const unsigned char *g, int score)
+{
+  const struct mmSpace *sp = cs->sp;
+  const uint64_t *pos[MM_MAX_LEN], *colour[MM_MAX_LEN];
+  unsigned char gc[MM_MAX_COLS + 1] = {0};
+  int exact = score >> 4, common = exact + (score & 0xF);
+
+  for (int i = 0; i < sp->len; i++)
+  {
+    pos[i] = mmIndexPos(cs->ix, i, g[i]);
+    colour[i] = mmIndexAtLeast(cs->ix, g[i], ++gc[g[i]]);
+  }
+
+  cs->count = 0;
+  for (uint32_t k = 0; k < cs->set.nwords; k++)
+  {
+    uint64_t w = cs->set.w[k], e[4] = {0, 0, 0, 0}, c[4] = {0, 0, 0, 0};
+
+    if (w == 0)
+      continue;
+    for (int i = 0; i < sp->len; i++)
+    {
+      sliceAdd(e, pos[i][k]);
+      sliceAdd(c, colour[i][k]);
+    }
+    w &= sliceEq(e, exact) & sliceEq(c, common);
+    cs->set.w[k] = w;
+    cs->count += __builtin_popcountll(w);
+  }
+}
+
+/* keep only the candidates that give feedback @score@ for @guess@ */
+uint32_t mmCandFilter(struct mmCandidates *cs, mmCode guess, int score)
+{
+  const struct mmSpace *sp = cs->sp;
+  unsigned char g[MM_MAX_LEN], s[MM_MAX_LEN];
+
+  if (sp->scoreIdx[score & 0xFF] == MM_NO_SCORE)
+  {
+    memset(cs->set.w, 0, cs->set.nwords * sizeof(uint64_t));
+    return cs->count = 0;
+  }
+
+  if (cs->mt != NULL)
+    return cs->count = mmBitsetAnd(&cs->set, mmMask(cs->mt, guess, score));
+
+  mmDecode(sp, guess, g);
+  if (cs->ix != NULL)
+  {
+    indexFilter(cs, g, score);
+    return cs->count;
+  }
+
+  // no mask table or index: rescan the remaining candidates only
+  for (uint32_t k = 0; k < cs->set.nwords; k++)
+  {
+    uint64_t word = cs->set.w[k];
+
+    while (word)
+    {
+      int b = __builtin_ctzll(word), sc;
+
+      word &= word - 1;
+      if (sp->packed != NULL)
+        sc = mmScorePacked(sp, &sp->packed[(k << 6) + b], &sp->packed[guess]);
+      else
+      {
+        mmDecode(sp, (k << 6) + b, s);
+        sc = mmScoreSeq(sp, s, g);
+      }
+      if (sc != score)
+      {
+        cs->set.w[k] &= ~((uint64_t)1 << b);
+        cs->count--;
+      }
+    }
+  }
+  return cs->count;
+}
+
+void mmCandFree(struct mmCandidates *cs)
+{
+  mmBitsetFree(&cs->set);
+}
+
+/* ======================================================= */
+/* SECTION: symmetry of the game history                   */
+/* ------------------------------------------------------- */
+
+/* no guesses yet: all colours are unused and all positions alike */
+void mmSymInit(struct mmSymmetry *sy, const struct mmSpace *sp)
+{
+  for (int i = 0; i < sp->len; i++)
+    sy->posClass[i] = 0;
+  sy->used = 0;
+}
+
+/* refine the symmetry by a new guess: it separates positions of different colour */
+void mmSymUpdate(struct mmSymmetry *sy, const struct mmSpace *sp, mmCode guess)
+{
+  unsigned char g[MM_MAX_LEN], cls[MM_MAX_LEN];
+
+  mmDecode(sp, guess, g);
+  for (int i = 0; i < sp->len; i++)
+  {
+    int j = 0;
+
+    while (sy->posClass[j] != sy->posClass[i] || g[j] != g[i])
+      j++;
+    cls[i] = j;
+    sy->used |= 1u << g[i];
+  }
+  memcpy(sy->posClass, cls, sp->len);
+}
+
+/* the canonical member of the class of @code@: unused colours are renamed to
+ * the lowest unused colours, ordered by how often they occur in each position
+ * class, and the pegs within each position class are sorted */
+mmCode mmSymCanonical(const struct mmSymmetry *sy, const struct mmSpace *sp, mmCode code)
+{
+  unsigned char g[MM_MAX_LEN], prof[MM_MAX_COLS + 1][MM_MAX_LEN];
+  unsigned char map[MM_MAX_COLS + 1];
+  int fc[MM_MAX_LEN], nf = 0;
+  mmCode res = 0;
+
+  mmDecode(sp, code, g);
+  memset(prof, 0, sizeof(prof));
+  for (int i = 0; i < sp->len; i++)
+    if (!(sy->used & (1u << g[i])))
+      prof[g[i]][sy->posClass[i]]++;
+
+  // order the unused colours occurring in @code@ by their profile, largest first
+  for (int c = 1; c <= sp->colors; c++)
+  {
+    int k, n = 0;
+
+    map[c] = c;
+    for (int i = 0; i < sp->len; i++)
+      n += prof[c][i];
+    if (n == 0)
+      continue;
+    for (k = nf; k > 0 && memcmp(prof[fc[k - 1]], prof[c], sp->len) < 0; k--)
+      fc[k] = fc[k - 1];
+    fc[k] = c;
+    nf++;
+  }
+  for (int k = 0, c = 1; k < nf; c++)
+    if (!(sy->used & (1u << c)))
+      map[fc[k++]] = c;
+
+  for (int i = 0; i < sp->len; i++)
+    g[i] = map[g[i]];
+
+  // sort the pegs within each position class
+  for (int i = 1; i < sp->len; i++)
+  {
+    unsigned char v = g[i];
+    int j = i;
+
+    while (j > 0)
+    {
+      int p = j - 1;
+
+      while (p >= 0 && sy->posClass[p] != sy->posClass[i])
+        p--;
+      if (p < 0 || g[p] <= v)
+        break;
+      g[j] = g[p];
+      j = p;
+    }
+    g[j] = v;
+  }
+
+  // renaming and sorting keep the colours distinct, so the result is in a space without repeats too
+  if (sp->distinct)
+    return rankDistinct(sp, g);
+  for (int i = 0; i < sp->len; i++)
+    res = res * sp->colors + (g[i] - 1);
+  return res;
+}
+
+/* whether every code is canonical: no two positions, and no two unused colours, are interchangeable */
+int mmSymTrivial(const struct mmSymmetry *sy, const struct mmSpace *sp)
+{
+  for (int i = 0; i < sp->len; i++)
+    if (sy->posClass[i] != i)
+      return 0;
+  for (int c = 1, nfree = 0; c <= sp->colors; c++)
+    if (!(sy->used & (1u << c)) && ++nfree > 1)
+      return 0;
+  return 1;
+}
+
+/* the first canonical code at or after @from@, or sp->size if there is none */
+mmCode mmSymNext(const struct mmSymmetry *sy, const struct mmSpace *sp, mmCode from)
+{
+  if (mmSymTrivial(sy, sp))
+    return from;
+
+  for (; from < sp->size; from++)
+    if (mmSymCanonical(sy, sp, from) == from)
+      return from;
+  return sp->size;
+}
+
+/* ======================================================= */
+/* SECTION: guess selection                                */
+/* ------------------------------------------------------- */
+
+/* number of candidates giving each feedback (by dense index) for @guess@ */
+void mmPartition(const struct mmCandidates *cs, mmCode guess, uint32_t *counts)
+{
+  const struct mmSpace *sp = cs->sp;
+  unsigned char g[MM_MAX_LEN], s[MM_MAX_LEN];
+
+  memset(counts, 0, sp->nscores * sizeof(uint32_t));
+
+  // with a mask table, an AND+popcount per score is cheaper than scoring each candidate
+  if (cs->mt != NULL && (uint64_t)sp->nscores * cs->set.nwords < (uint64_t)cs->count * sp->len)
+  {
+    for (int idx = 0; idx < sp->nscores; idx++)
+    {
+      const uint64_t *m = mmMask(cs->mt, guess, sp->scoreVal[idx]);
+
+      for (uint32_t k = 0; k < cs->set.nwords; k++)
+        counts[idx] += __builtin_popcountll(cs->set.w[k] & m[k]);
+    }
+    return;
+  }
+
+  if (sp->packed != NULL)
+  { // no decoding at all: the candidates are scored in their packed form
+    const struct mmPacked *pg = &sp->packed[guess];
+
+    for (uint32_t i = mmBitsetNext(&cs->set, 0); i < sp->size; i = mmBitsetNext(&cs->set, i + 1))
+      counts[sp->scoreIdx[mmScorePacked(sp, &sp->packed[i], pg)]]++;
+    return;
+  }
+  mmDecode(sp, guess, g);
+  for (uint32_t i = mmBitsetNext(&cs->set, 0); i < sp->size; i = mmBitsetNext(&cs->set, i + 1))
+  {
+    mmDecode(sp, i, s);
+    counts[sp->scoreIdx[mmScoreSeq(sp, s, g)]]++;
+  }
+}
+
+/* the guess minimising the expected number of remaining candidates, i.e. the
+ * sum of squared partition sizes; ties go to candidates, then to lower codes.
+ * With @sy@ given, only one guess per symmetry class is evaluated. */
+mmCode mmBestGuess(const struct mmCandidates *cs, const struct mmSymmetry *sy, uint64_t *quality)
+{
+  const struct mmSpace *sp = cs->sp;
+  uint32_t counts[MM_MAX_SCORES];
+  uint64_t best = UINT64_MAX;
+  mmCode bestGuess = sp->size;
+  int bestIsCand = 0;
+
+  if (cs->count == 1)
+    bestGuess = mmBitsetNext(&cs->set, 0);
+
+  for (mmCode g = sy ? mmSymNext(sy, sp, 0) : 0; g < sp->size && cs->count > 1;
+       g = sy ? mmSymNext(sy, sp, g + 1) : g + 1)
+  {
+    uint64_t q = 0;
+    int isCand = mmBitsetTest(&cs->set, g);
+
+    mmPartition(cs, g, counts);
+    for (int idx = 0; idx < sp->nscores; idx++)
+      q += (uint64_t)counts[idx] * counts[idx];
+    if (q < best || (q == best && isCand && !bestIsCand))
+    {
+      best = q;
+      bestGuess = g;
+      bestIsCand = isCand;
+    }
+  }
+
+  if (quality != NULL)
+    *quality = cs->count == 1 ? 1 : best;
+  return bestGuess;
+}
+
+/* like mmBestGuess(), but giving up after about @budget@ scorings, for a hint
+ * that must be cheap on the Pi: the candidates are evaluated first, then the
+ * other canonical guesses while the budget lasts; testing a code for being
+ * canonical counts as one scoring per peg. Always returns a candidate or a better
+ * guess, or sp->size if there are no candidates. */
+mmCode mmHintGuess(const struct mmCandidates *cs, const struct mmSymmetry *sy, uint64_t budget)
+{
+  const struct mmSpace *sp = cs->sp;
+  uint32_t counts[MM_MAX_SCORES];
+  uint64_t best = UINT64_MAX, spent = 0, perGuess;
+  mmCode bestGuess = mmBitsetNext(&cs->set, 0);
+  int sym;
+
+  if (cs->count <= 1)
+    return cs->count == 1 ? bestGuess : sp->size;
+
+  // what one mmPartition() costs, counted in scorings; walking the bitset
+  // costs about one per 8 words, which dominates once few candidates are left
+  perGuess = cs->count + cs->set.nwords / 8;
+  if (cs->mt != NULL && (uint64_t)sp->nscores * cs->set.nwords < perGuess * sp->len)
+    perGuess = ((uint64_t)sp->nscores * cs->set.nwords + sp->len - 1) / sp->len;
+
+  // a guess splitting the candidates into singletons cannot be beaten
+  for (mmCode g = bestGuess; g < sp->size && spent + perGuess <= budget && best > cs->count;
+       g = mmBitsetNext(&cs->set, g + 1), spent += perGuess)
+  {
+    uint64_t q = 0;
+
+    mmPartition(cs, g, counts);
+    for (int idx = 0; idx < sp->nscores; idx++)
+      q += (uint64_t)counts[idx] * counts[idx];
+    if (q < best)
+    {
+      best = q;
+      bestGuess = g;
+    }
+  }
+
+  // a non-candidate only wins if it is strictly better; the scan for canonical
+  // codes is paid for too, as it can pass over most of a big space
+  sym = sy != NULL && !mmSymTrivial(sy, sp);
+  for (mmCode g = 0; g < sp->size && spent + perGuess <= budget && best > cs->count; g++)
+  {
+    uint64_t q = 0;
+
+    if (mmBitsetTest(&cs->set, g))
+      continue;
+    if (sym)
+    {
+      spent += sp->len;
+      if (mmSymCanonical(sy, sp, g) != g)
+        continue;
+    }
+    mmPartition(cs, g, counts);
+    spent += perGuess;
+    for (int idx = 0; idx < sp->nscores; idx++)
+      q += (uint64_t)counts[idx] * counts[idx];
+    if (q < best)
+    {
+      best = q;
+      bestGuess = g;
+    }
+  }
+  return bestGuess;
+}
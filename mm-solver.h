@@ -0,0 +1,235 @@
+/*
+ * Code space, scoring and candidate-set data structures for MasterMind.
+ * Shared by the game (master-mind.c) and the solver code.
+ *
+ * A code (sequence of pegs) is represented by its index in the code space,
+ * i.e. the sequence read as a number in base @colors@, with the first peg as
+ * the most significant digit. Pegs are numbered 1..colors, as in master-mind.c.
+ * Feedback uses the same encoding as countMatches(): (exact << 4) | approximate.
+ *
+ * In the variant without repeated colours (as in Bulls & Cows), only codes
+ * whose pegs all differ are in the space, indexed in the same order, i.e. by
+ * rank among those codes. With mmSpacePack() they are also kept packed, which
+ * makes scoring a few word operations (mmScorePacked()); the streaming solver
+ * instead packs each code as it visits it.
+ */
+
+#ifndef MM_SOLVER_H
+#define MM_SOLVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ======================================================= */
+/* SECTION: code space                                     */
+/* ------------------------------------------------------- */
+
+#define MM_MAX_LEN 8   // max length of a sequence
+#define MM_MAX_COLS 10 // max number of colours
+#define MM_MAX_SCORES 64
+
+#define MM_NO_SCORE 0xFF
+
+typedef uint32_t mmCode;
+
+/* a code without repeated colours: peg i in bits 4i..4i+3, and bit c set for each colour c */
+struct mmPacked
+{
+  uint32_t pegs, colours;
+};
+
+struct mmSpace
+{
+  int len, colors;
+  int distinct;                            // no colour more than once in a code
+  uint32_t size;                           // number of codes, colors^len or colors!/(colors-len)!
+  int nscores;                             // number of possible feedback values
+  uint32_t pow[MM_MAX_LEN];                // place value of each position
+  unsigned char scoreIdx[256];             // packed feedback -> dense index, or MM_NO_SCORE
+  unsigned char scoreVal[MM_MAX_SCORES];   // dense index -> packed feedback
+  struct mmPacked *packed;                 // all codes packed (mmSpacePack()), else NULL
+};
+
+/* default cap on the table of packed codes */
+#define MM_PACK_MAX_BYTES (16 * 1024 * 1024)
+
+int mmSpaceInit(struct mmSpace *sp, int len, int colors);
+int mmSpaceInitDistinct(struct mmSpace *sp, int len, int colors);
+int mmSpacePack(struct mmSpace *sp, size_t maxBytes);
+void mmSpaceFree(struct mmSpace *sp);
+
+void mmDecode(const struct mmSpace *sp, mmCode code, unsigned char *seq);
+mmCode mmEncode(const struct mmSpace *sp, const int *seq);
+
+int mmScoreSeq(const struct mmSpace *sp, const unsigned char *secret, const unsigned char *guess);
+int mmScore(const struct mmSpace *sp, mmCode secret, mmCode guess);
+
+/* the packed form of the sequence @seq@ of a space without repeats */
+static inline void mmPackSeq(const struct mmSpace *sp, const unsigned char *seq, struct mmPacked *p)
+{
+  p->pegs = p->colours = 0;
+  for (int i = 0; i < sp->len; i++)
+  {
+    p->pegs |= (uint32_t)seq[i] << 4 * i;
+    p->colours |= 1u << seq[i];
+  }
+}
+
+/* feedback for codes without repeated colours: the colours in common are the
+ * bits both colour sets have, the exact matches the zero nibbles of the XOR
+ * of the pegs (each nibble folded into its lowest bit) */
+static inline int mmScorePacked(const struct mmSpace *sp, const struct mmPacked *secret, const struct mmPacked *guess)
+{
+  uint32_t x = secret->pegs ^ guess->pegs;
+  int common = __builtin_popcount(secret->colours & guess->colours), exact;
+
+  x = (x | x >> 1 | x >> 2 | x >> 3) & (0x11111111u >> (32 - 4 * sp->len));
+  exact = sp->len - __builtin_popcount(x);
+  return (exact << 4) | (common - exact);
+}
+
+/* packed feedback for a guess that matches the secret exactly */
+#define MM_WIN(sp) ((sp)->len << 4)
+
+/* ======================================================= */
+/* SECTION: bitsets                                        */
+/* ------------------------------------------------------- */
+
+struct mmBitset
+{
+  uint32_t nbits, nwords;
+  uint64_t *w;
+};
+
+int mmBitsetInit(struct mmBitset *bs, uint32_t nbits);
+void mmBitsetFree(struct mmBitset *bs);
+void mmBitsetFill(struct mmBitset *bs);
+uint32_t mmBitsetCount(const struct mmBitset *bs);
+uint32_t mmBitsetAnd(struct mmBitset *bs, const uint64_t *mask);
+
+static inline void mmBitsetSet(struct mmBitset *bs, uint32_t i)
+{
+  bs->w[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+static inline int mmBitsetTest(const struct mmBitset *bs, uint32_t i)
+{
+  return (bs->w[i >> 6] >> (i & 63)) & 1;
+}
+
+/* index of the first set bit at or after @i@, or nbits if there is none */
+static inline uint32_t mmBitsetNext(const struct mmBitset *bs, uint32_t i)
+{
+  uint32_t k = i >> 6;
+  uint64_t word;
+
+  if (i >= bs->nbits)
+    return bs->nbits;
+  word = bs->w[k] & (~(uint64_t)0 << (i & 63));
+  while (word == 0)
+  {
+    if (++k == bs->nwords)
+      return bs->nbits;
+    word = bs->w[k];
+  }
+  return (k << 6) + __builtin_ctzll(word);
+}
+
+/* ======================================================= */
+/* SECTION: candidate sets                                 */
+/* ------------------------------------------------------- */
+
+/* default cap on the size of a (guess, score) mask table */
+#define MM_MASK_MAX_BYTES (16 * 1024 * 1024)
+
+/* one bitset per (guess, score): all secrets that give @score@ for @guess@ */
+struct mmMaskTable
+{
+  const struct mmSpace *sp;
+  uint32_t nwords;
+  uint64_t *masks;
+};
+
+int mmMaskTableBuild(struct mmMaskTable *mt, const struct mmSpace *sp, size_t maxBytes);
+void mmMaskTableFree(struct mmMaskTable *mt);
+
+static inline const uint64_t *mmMask(const struct mmMaskTable *mt, mmCode guess, int score)
+{
+  return mt->masks + ((size_t)guess * mt->sp->nscores + mt->sp->scoreIdx[score]) * mt->nwords;
+}
+
+/* default cap on the size of an inverted index */
+#define MM_INDEX_MAX_BYTES (16 * 1024 * 1024)
+
+/* inverted index over the code space, a few bitsets per position and colour
+ * instead of one per (guess, score): all codes with colour c in position i,
+ * and all codes with at least k pegs of colour c. Feedback is applied by
+ * adding up len bitsets of each kind word by word, in bit-sliced counters,
+ * so filtering streams through memory instead of scoring every candidate. */
+struct mmIndex
+{
+  const struct mmSpace *sp;
+  uint32_t nwords;
+  uint64_t *pos;     // [len][colors] bitsets
+  uint64_t *atLeast; // [colors][len] bitsets, for 1..len pegs
+};
+
+int mmIndexBuild(struct mmIndex *ix, const struct mmSpace *sp, size_t maxBytes);
+void mmIndexFree(struct mmIndex *ix);
+
+/* codes with colour @color@ (1..colors) in position @i@ */
+static inline const uint64_t *mmIndexPos(const struct mmIndex *ix, int i, int color)
+{
+  return ix->pos + ((size_t)i * ix->sp->colors + color - 1) * ix->nwords;
+}
+
+/* codes with at least @k@ (1..len) pegs of colour @color@ */
+static inline const uint64_t *mmIndexAtLeast(const struct mmIndex *ix, int color, int k)
+{
+  return ix->atLeast + ((size_t)(color - 1) * ix->sp->len + k - 1) * ix->nwords;
+}
+
+/* the set of secrets still consistent with all feedback so far */
+struct mmCandidates
+{
+  const struct mmSpace *sp;
+  const struct mmMaskTable *mt; // NULL if the space is too big for a mask table
+  const struct mmIndex *ix;     // prefilter without a mask table, NULL for none
+  struct mmBitset set;
+  uint32_t count;
+};
+
+int mmCandInit(struct mmCandidates *cs, const struct mmSpace *sp, const struct mmMaskTable *mt,
+               const struct mmIndex *ix);
+void mmCandReset(struct mmCandidates *cs);
+uint32_t mmCandFilter(struct mmCandidates *cs, mmCode guess, int score);
+void mmCandFree(struct mmCandidates *cs);
+
+/* ======================================================= */
+/* SECTION: symmetry of the game history                   */
+/* ------------------------------------------------------- */
+
+/* Guesses are interchangeable under any permutation of the colours not used
+ * in any guess so far, and of positions that every guess so far has coloured
+ * alike. Only one canonical representative per class needs to be evaluated. */
+struct mmSymmetry
+{
+  unsigned char posClass[MM_MAX_LEN]; // lowest position in the same class
+  uint32_t used;                      // bit c is set if colour c has been guessed
+};
+
+void mmSymInit(struct mmSymmetry *sy, const struct mmSpace *sp);
+void mmSymUpdate(struct mmSymmetry *sy, const struct mmSpace *sp, mmCode guess);
+mmCode mmSymCanonical(const struct mmSymmetry *sy, const struct mmSpace *sp, mmCode code);
+int mmSymTrivial(const struct mmSymmetry *sy, const struct mmSpace *sp);
+mmCode mmSymNext(const struct mmSymmetry *sy, const struct mmSpace *sp, mmCode from);
+
+/* ======================================================= */
+/* SECTION: guess selection                                */
+/* ------------------------------------------------------- */
+
+void mmPartition(const struct mmCandidates *cs, mmCode guess, uint32_t *counts);
+mmCode mmBestGuess(const struct mmCandidates *cs, const struct mmSymmetry *sy, uint64_t *quality);
+mmCode mmHintGuess(const struct mmCandidates *cs, const struct mmSymmetry *sy, uint64_t budget);
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * Counters and phase timers, see mm-stats.h. Only built with MM_STATS.
+ */
+
+#ifdef MM_STATS
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mm-stats.h"
+
+_Thread_local struct mmStats mmStatsLocal;
+
+/* the blocks of all registered threads, summed up by mmStatsDump() */
+static struct mmStats *threads[MM_STATS_MAX_THREADS];
+static int nthreads;
+
+static const char *phaseNames[MM_NPHASES] = {"input window", "feedback", "LCD update"};
+static const char *latencyNames[MM_NLATENCIES] = {"press to count", "last peg to match", "match to LCD"};
+
+uint64_t mmStatsNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void mmStatsPhase(enum mmPhase phase, uint64_t startNs)
+{
+  struct mmPhaseTimes *pt = &mmStatsLocal.phase[phase];
+  uint64_t ns = mmStatsNow() - startNs;
+
+  pt->count++;
+  pt->totalNs += ns;
+  if (ns > pt->maxNs)
+    pt->maxNs = ns;
+}
+
+/* add the calling thread's counters to the summary; the thread must outlive it */
+void mmStatsRegister(void)
+{
+  int n = __atomic_fetch_add(&nthreads, 1, __ATOMIC_ACQ_REL);
+
+  if (n < MM_STATS_MAX_THREADS)
+    __atomic_store_n(&threads[n], &mmStatsLocal, __ATOMIC_RELEASE);
+}
+
+/* ======================================================= */
+/* SECTION: the summary                                    */
+/* ------------------------------------------------------- */
+/* formatted by hand, since only write() may be used in a signal handler */
+
+struct outBuf
+{
+  char b[4096];
+  size_t n;
+};
+
+static void putStr(struct outBuf *o, const char *s)
+{
+  while (*s && o->n < sizeof(o->b))
+    o->b[o->n++] = *s++;
+}
+
+static void putNum(struct outBuf *o, uint64_t v)
+{
+  char d[24];
+  int i = sizeof(d) - 1;
+
+  d[i] = '\0';
+  do
+    d[--i] = '0' + v % 10;
+  while ((v /= 10) != 0);
+  putStr(o, d + i);
+}
+
+/* @ns@ in microseconds */
+static void putUs(struct outBuf *o, uint64_t ns)
+{
+  putNum(o, ns / 1000);
+  putStr(o, " us");
+}
+
+/* write the summary over all registered threads to @fd@; async-signal-safe */
+void mmStatsDump(int fd)
+{
+  struct mmStats sum;
+  struct outBuf o;
+  int n = __atomic_load_n(&nthreads, __ATOMIC_ACQUIRE);
+
+  memset(&sum, 0, sizeof(sum));
+  if (n > MM_STATS_MAX_THREADS)
+    n = MM_STATS_MAX_THREADS;
+  for (int t = 0; t < n; t++)
+  {
+    const struct mmStats *s = __atomic_load_n(&threads[t], __ATOMIC_ACQUIRE);
+
+    if (s == NULL)
+      continue;
+    for (int p = 0; p < MM_STATS_PINS; p++)
+      sum.gpioWrites[p] += s->gpioWrites[p];
+    sum.lcdCommands += s->lcdCommands;
+    sum.lcdData += s->lcdData;
+    sum.strobes += s->strobes;
+    sum.sleepRequestedNs += s->sleepRequestedNs;
+    sum.sleepActualNs += s->sleepActualNs;
+    sum.buttonSamples += s->buttonSamples;
+    sum.matchCalls += s->matchCalls;
+    for (int p = 0; p < MM_NPHASES; p++)
+    {
+      sum.phase[p].count += s->phase[p].count;
+      sum.phase[p].totalNs += s->phase[p].totalNs;
+      if (s->phase[p].maxNs > sum.phase[p].maxNs)
+        sum.phase[p].maxNs = s->phase[p].maxNs;
+    }
+    for (int l = 0; l < MM_NLATENCIES; l++)
+      mmHistMerge(&sum.latency[l], &s->latency[l]);
+  }
+
+  o.n = 0;
+  putStr(&o, "stats: GPIO writes per pin:");
+  for (int p = 0; p < MM_STATS_PINS; p++)
+    if (sum.gpioWrites[p] != 0)
+    {
+      putStr(&o, " ");
+      putNum(&o, p);
+      putStr(&o, "=");
+      putNum(&o, sum.gpioWrites[p]);
+    }
+  putStr(&o, "\nstats: LCD commands ");
+  putNum(&o, sum.lcdCommands);
+  putStr(&o, ", data bytes ");
+  putNum(&o, sum.lcdData);
+  putStr(&o, ", strobes ");
+  putNum(&o, sum.strobes);
+  putStr(&o, "\nstats: sleep requested ");
+  putUs(&o, sum.sleepRequestedNs);
+  putStr(&o, ", actual ");
+  putUs(&o, sum.sleepActualNs);
+  putStr(&o, "\nstats: button samples ");
+  putNum(&o, sum.buttonSamples);
+  putStr(&o, ", countMatches calls ");
+  putNum(&o, sum.matchCalls);
+  putStr(&o, "\n");
+  for (int p = 0; p < MM_NPHASES; p++)
+  {
+    putStr(&o, "stats: phase ");
+    putStr(&o, phaseNames[p]);
+    putStr(&o, ": ");
+    putNum(&o, sum.phase[p].count);
+    putStr(&o, " times, total ");
+    putUs(&o, sum.phase[p].totalNs);
+    putStr(&o, ", max ");
+    putUs(&o, sum.phase[p].maxNs);
+    putStr(&o, "\n");
+  }
+  for (int l = 0; l < MM_NLATENCIES; l++)
+  {
+    const struct mmHist *h = &sum.latency[l];
+
+    putStr(&o, "stats: latency ");
+    putStr(&o, latencyNames[l]);
+    putStr(&o, ": ");
+    putNum(&o, h->count);
+    putStr(&o, " times, p50 ");
+    putUs(&o, mmHistPercentile(h, 500));
+    putStr(&o, ", p99 ");
+    putUs(&o, mmHistPercentile(h, 990));
+    putStr(&o, ", max ");
+    putUs(&o, h->max);
+    putStr(&o, "\n");
+  }
+
+  for (size_t off = 0; off < o.n;)
+  {
+    ssize_t w = write(fd, o.b + off, o.n - off);
+
+    if (w <= 0)
+      break;
+    off += w;
+  }
+}
+
+static void onSignal(int signum)
+{
+  (void)signum;
+  mmStatsDump(STDERR_FILENO);
+}
+
+static void onExit(void)
+{
+  mmStatsDump(STDERR_FILENO);
+}
+
+/* register the calling thread, and print the summary at exit and on SIGUSR1 */
+void mmStatsInit(void)
+{
+  struct sigaction sa;
+
+  mmStatsRegister();
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = onSignal;
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGUSR1, &sa, NULL);
+  atexit(onExit);
+}
+
+#endif
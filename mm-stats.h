@@ -0,0 +1,102 @@
+/*
+ * Optional instrumentation of the hot paths: counters for GPIO writes, LCD
+ * traffic, sleeps, button samples and matching, plus timers for the phases of
+ * a round, and histograms of the latencies the player sees. Everything here
+ * compiles to nothing unless MM_STATS is defined (make STATS=1), so the
+ * default build pays nothing for it.
+ *
+ * Counters live in a thread-local block and are bumped without atomics or
+ * locks; each thread that should appear in the summary registers its block
+ * once (mmStatsInit() does this for the calling thread). The summary goes to
+ * stderr at exit, and on SIGUSR1 while the program is running.
+ */
+
+#ifndef MM_STATS_H
+#define MM_STATS_H
+
+#include <stdint.h>
+
+#include "mm-hist.h"
+
+/* phases of a round; they may nest (LCD updates happen during feedback) */
+enum mmPhase
+{
+  MM_PHASE_INPUT,    // the input window, waiting for button presses
+  MM_PHASE_FEEDBACK, // matching and showing the result on LEDs and LCD
+  MM_PHASE_LCD,      // any single LCD update (clear, or writing a string)
+  MM_NPHASES
+};
+
+/* user-facing latencies, on the game clock (mmNow()) */
+enum mmLatency
+{
+  MM_LAT_PRESS,   // button or key edge to the press being counted; the edge
+                  // is taken as the last sample that saw it released
+  MM_LAT_MATCH,   // end of the input window of the last peg to the countMatches() result
+  MM_LAT_DISPLAY, // countMatches() result to "Exact:/Approx:" on the LCD
+  MM_NLATENCIES
+};
+
+#ifdef MM_STATS
+
+#define MM_STATS_PINS 64
+#define MM_STATS_MAX_THREADS 16
+
+struct mmPhaseTimes
+{
+  uint64_t count, totalNs, maxNs;
+};
+
+struct mmStats
+{
+  uint64_t gpioWrites[MM_STATS_PINS];
+  uint64_t lcdCommands, lcdData, strobes;
+  uint64_t sleepRequestedNs, sleepActualNs;
+  uint64_t buttonSamples, matchCalls;
+  struct mmPhaseTimes phase[MM_NPHASES];
+  struct mmHist latency[MM_NLATENCIES];
+};
+
+extern _Thread_local struct mmStats mmStatsLocal;
+
+void mmStatsInit(void);
+void mmStatsRegister(void);
+void mmStatsDump(int fd);
+uint64_t mmStatsNow(void);
+void mmStatsPhase(enum mmPhase phase, uint64_t startNs);
+
+#define MM_STATS_INIT() mmStatsInit()
+#define MM_COUNT(field) (mmStatsLocal.field++)
+#define MM_COUNT_PIN(pin) (mmStatsLocal.gpioWrites[(pin) & (MM_STATS_PINS - 1)]++)
+
+/* time a sleep of @reqNs@ nanoseconds, between BEGIN and END in one block */
+#define MM_SLEEP_BEGIN() uint64_t mmSleepStart_ = mmStatsNow()
+#define MM_SLEEP_END(reqNs)                                     \
+  do                                                            \
+  {                                                             \
+    mmStatsLocal.sleepRequestedNs += (reqNs);                   \
+    mmStatsLocal.sleepActualNs += mmStatsNow() - mmSleepStart_; \
+  } while (0)
+
+/* time a phase, between BEGIN and END in one block */
+#define MM_PHASE_BEGIN(p) uint64_t mmPhaseStart_##p = mmStatsNow()
+#define MM_PHASE_END(p) mmStatsPhase(p, mmPhaseStart_##p)
+
+/* record a latency of @ns@ nanoseconds */
+#define MM_LATENCY(l, ns) mmHistRecord(&mmStatsLocal.latency[l], (ns))
+
+#else
+
+#define MM_STATS_INIT() ((void)0)
+#define MM_COUNT(field) ((void)0)
+#define MM_COUNT_PIN(pin) ((void)0)
+#define MM_SLEEP_BEGIN() ((void)0)
+#define MM_SLEEP_END(reqNs) ((void)0)
+#define MM_PHASE_BEGIN(p) ((void)0)
+#define MM_PHASE_END(p) ((void)0)
+// the latency is not computed, but its operands count as used
+#define MM_LATENCY(l, ns) ((void)sizeof(ns))
+
+#endif
+
+#endif
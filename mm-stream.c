@@ -0,0 +1,429 @@
+/*
+ * Compressed candidate sets and streamed guess evaluation, see mm-stream.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "mm-stream.h"
+
+#define BITMAP_BYTES (MM_CHUNK_SIZE / 8)
+
+/* ======================================================= */
+/* SECTION: counted allocation                             */
+/* ------------------------------------------------------- */
+
+static void *streamAlloc(struct mmStream *st, size_t bytes)
+{
+  void *p;
+
+  if (st->bytes + bytes > st->capBytes || (p = malloc(bytes)) == NULL)
+    return NULL;
+  st->bytes += bytes;
+  if (st->bytes > st->peakBytes)
+    st->peakBytes = st->bytes;
+  return p;
+}
+
+static void streamRelease(struct mmStream *st, void *p, size_t bytes)
+{
+  free(p);
+  st->bytes -= bytes;
+}
+
+static size_t chunkBytes(const struct mmChunk *c)
+{
+  switch (c->type) {
+  case MM_CHUNK_ARRAY:
+    return c->n * sizeof(uint16_t);
+  case MM_CHUNK_BITMAP:
+    return BITMAP_BYTES;
+  default:
+    return c->n * 2 * sizeof(uint16_t);
+  }
+}
+
+/* ======================================================= */
+/* SECTION: containers                                     */
+/* ------------------------------------------------------- */
+
+/* the low halves of all codes in @c@, in order, into @out@; returns how many */
+static uint32_t chunkExpand(const struct mmChunk *c, uint16_t *out)
+{
+  uint32_t m = 0;
+
+  switch (c->type) {
+  case MM_CHUNK_ARRAY:
+    memcpy(out, c->data, c->n * sizeof(uint16_t));
+    return c->n;
+  case MM_CHUNK_BITMAP:
+    for (uint32_t k = 0; k < MM_CHUNK_SIZE / 64; k++)
+    {
+      uint64_t word = ((const uint64_t *)c->data)[k];
+
+      while (word)
+      {
+        out[m++] = (k << 6) + __builtin_ctzll(word);
+        word &= word - 1;
+      }
+    }
+    return m;
+  default:
+    for (uint32_t r = 0; r < c->n; r++)
+    {
+      const uint16_t *run = (const uint16_t *)c->data + 2 * r;
+
+      for (uint32_t v = run[0]; v <= (uint32_t)run[0] + run[1]; v++)
+        out[m++] = v;
+    }
+    return m;
+  }
+}
+
+/* store the @m@ (> 0) sorted low halves in @in@ as chunk @c@, in the smallest kind of container */
+static int chunkEncode(struct mmStream *st, struct mmChunk *c, const uint16_t *in, uint32_t m)
+{
+  uint32_t runs = 1;
+  size_t bytes;
+
+  for (uint32_t i = 1; i < m; i++)
+    runs += in[i] != in[i - 1] + 1;
+
+  c->card = m;
+  if (runs * 2 <= m && runs * 2 * sizeof(uint16_t) <= BITMAP_BYTES)
+  {
+    uint16_t *run;
+
+    c->type = MM_CHUNK_RUN;
+    c->n = runs;
+    if ((run = (uint16_t *)streamAlloc(st, bytes = runs * 2 * sizeof(uint16_t))) == NULL)
+      return -1;
+    for (uint32_t i = 0, r = 0; i < m; i++)
+      if (i == 0 || in[i] != in[i - 1] + 1)
+      {
+        run[2 * r] = in[i];
+        run[2 * r + 1] = 0;
+        r++;
+      }
+      else
+        run[2 * r - 1]++;
+    c->data = run;
+  }
+  else if (m <= MM_ARRAY_MAX)
+  {
+    c->type = MM_CHUNK_ARRAY;
+    c->n = m;
+    if ((c->data = streamAlloc(st, bytes = m * sizeof(uint16_t))) == NULL)
+      return -1;
+    memcpy(c->data, in, bytes);
+  }
+  else
+  {
+    uint64_t *bits;
+
+    c->type = MM_CHUNK_BITMAP;
+    c->n = 0;
+    if ((bits = (uint64_t *)streamAlloc(st, BITMAP_BYTES)) == NULL)
+      return -1;
+    memset(bits, 0, BITMAP_BYTES);
+    for (uint32_t i = 0; i < m; i++)
+      bits[in[i] >> 6] |= (uint64_t)1 << (in[i] & 63);
+    c->data = bits;
+  }
+  return 0;
+}
+
+/* ======================================================= */
+/* SECTION: candidate sets                                 */
+/* ------------------------------------------------------- */
+
+static void freeChunks(struct mmStream *st)
+{
+  for (uint32_t i = 0; i < st->nchunks; i++)
+    streamRelease(st, st->chunks[i].data, chunkBytes(&st->chunks[i]));
+  if (st->chunks != NULL)
+    streamRelease(st, st->chunks, st->maxChunks * sizeof(struct mmChunk));
+  st->chunks = NULL;
+  st->nchunks = st->maxChunks = 0;
+}
+
+/* all codes of @sp@ as candidates, using at most @capBytes@ */
+int mmStreamInit(struct mmStream *st, const struct mmSpace *sp, size_t capBytes)
+{
+  memset(st, 0, sizeof(*st));
+  st->sp = sp;
+  st->capBytes = capBytes;
+  if ((st->scratch = (uint16_t *)streamAlloc(st, MM_CHUNK_SIZE * sizeof(uint16_t))) == NULL)
+    return -1;
+  return mmStreamReset(st);
+}
+
+/* back to all codes; each chunk is a single run */
+int mmStreamReset(struct mmStream *st)
+{
+  uint32_t n = (st->sp->size + MM_CHUNK_SIZE - 1) / MM_CHUNK_SIZE;
+
+  freeChunks(st);
+  if ((st->chunks = (struct mmChunk *)streamAlloc(st, n * sizeof(struct mmChunk))) == NULL)
+    return -1;
+  st->maxChunks = n;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    struct mmChunk *c = &st->chunks[i];
+    uint32_t last = st->sp->size - ((mmCode)i << MM_CHUNK_BITS) - 1;
+    uint16_t *run;
+
+    if ((run = (uint16_t *)streamAlloc(st, 2 * sizeof(uint16_t))) == NULL)
+      return -1;
+    run[0] = 0;
+    run[1] = last < MM_CHUNK_SIZE - 1 ? last : MM_CHUNK_SIZE - 1;
+    c->key = i;
+    c->type = MM_CHUNK_RUN;
+    c->card = run[1] + 1;
+    c->n = 1;
+    c->data = run;
+    st->nchunks++;
+  }
+  st->count = st->sp->size;
+  return 0;
+}
+
+void mmStreamFree(struct mmStream *st)
+{
+  freeChunks(st);
+  streamRelease(st, st->scratch, MM_CHUNK_SIZE * sizeof(uint16_t));
+  st->scratch = NULL;
+}
+
+/* the next sequence without repeats after @seq@: raise the last position that
+ * can take a larger unused colour, then fill the rest with the smallest ones */
+static inline void nextDistinct(const struct mmSpace *sp, unsigned char *seq)
+{
+  uint32_t all = (2u << sp->colors) - 2, used = 0;
+
+  for (int i = 0; i < sp->len; i++)
+    used |= 1u << seq[i];
+  for (int i = sp->len - 1; i >= 0; i--)
+  {
+    uint32_t up;
+
+    used &= ~(1u << seq[i]);
+    if ((up = all & ~used & ~((2u << seq[i]) - 1)) == 0)
+      continue;
+    seq[i] = __builtin_ctz(up);
+    used |= 1u << seq[i];
+    for (int j = i + 1; j < sp->len; j++)
+    {
+      seq[j] = __builtin_ctz(all & ~used);
+      used |= 1u << seq[j];
+    }
+    return;
+  }
+}
+
+/* advance @seq@ to @code@: one step of an odometer if it is the next code, else decode */
+static inline void seqTo(const struct mmSpace *sp, unsigned char *seq, mmCode *at, mmCode code)
+{
+  if (code == *at + 1 && sp->distinct)
+    nextDistinct(sp, seq);
+  else if (code == *at + 1)
+  {
+    for (int i = sp->len - 1; ++seq[i] > sp->colors; i--)
+      seq[i] = 1;
+  }
+  else
+    mmDecode(sp, code, seq);
+  *at = code;
+}
+
+/* keep only the candidates that give feedback @score@ for @guess@, chunk by chunk;
+ * -1 if the result does not fit under the cap */
+int mmStreamFilter(struct mmStream *st, mmCode guess, int score)
+{
+  const struct mmSpace *sp = st->sp;
+  unsigned char g[MM_MAX_LEN], s[MM_MAX_LEN];
+  struct mmPacked gp, ps;
+  mmCode at = UINT32_MAX - 1;
+  uint32_t kept = 0;
+
+  mmDecode(sp, guess, g);
+  if (sp->distinct)
+    mmPackSeq(sp, g, &gp);
+  st->count = 0;
+  for (uint32_t i = 0; i < st->nchunks; i++)
+  {
+    struct mmChunk *c = &st->chunks[i];
+    mmCode base = (mmCode)c->key << MM_CHUNK_BITS;
+    uint32_t n = chunkExpand(c, st->scratch), m = 0;
+
+    for (uint32_t j = 0; j < n; j++)
+    {
+      int sc;
+
+      // codes are packed as they are visited, so nothing the size of the space is held
+      seqTo(sp, s, &at, base + st->scratch[j]);
+      if (sp->distinct)
+      {
+        mmPackSeq(sp, s, &ps);
+        sc = mmScorePacked(sp, &ps, &gp);
+      }
+      else
+        sc = mmScoreSeq(sp, s, g);
+      if (sc == score)
+        st->scratch[m++] = st->scratch[j];
+    }
+    st->scorings += n;
+
+    // replace the container in place, so only one chunk is ever held twice
+    streamRelease(st, c->data, chunkBytes(c));
+    c->data = NULL;
+    c->n = 0;
+    c->type = MM_CHUNK_ARRAY;
+    if (m == 0)
+      continue;
+    if (chunkEncode(st, c, st->scratch, m) < 0)
+    { // drop this chunk but keep the others, so that the set can still be freed
+      for (uint32_t j = i + 1; j < st->nchunks; j++)
+        st->chunks[kept++] = st->chunks[j];
+      st->nchunks = kept;
+      return -1;
+    }
+    st->count += m;
+    st->chunks[kept++] = *c;
+  }
+  st->nchunks = kept;
+  return 0;
+}
+
+/* the candidate of rank @rank@ (0-based), or sp->size if there are fewer */
+mmCode mmStreamSelect(struct mmStream *st, uint64_t rank)
+{
+  for (uint32_t i = 0; i < st->nchunks; i++)
+  {
+    const struct mmChunk *c = &st->chunks[i];
+
+    if (rank < c->card)
+    {
+      chunkExpand(c, st->scratch);
+      return ((mmCode)c->key << MM_CHUNK_BITS) + st->scratch[rank];
+    }
+    rank -= c->card;
+  }
+  return st->sp->size;
+}
+
+/* ======================================================= */
+/* SECTION: guess selection                                */
+/* ------------------------------------------------------- */
+
+/* partition sizes of @n@ guesses at once, in one pass over the candidates:
+ * counts[k * nscores + idx] is the number of candidates giving score index @idx@ for guesses[k] */
+void mmStreamPartition(struct mmStream *st, const mmCode *guesses, int n, uint32_t *counts)
+{
+  const struct mmSpace *sp = st->sp;
+  unsigned char g[n][MM_MAX_LEN], s[MM_MAX_LEN];
+  struct mmPacked gp[n], ps;
+  mmCode at = UINT32_MAX - 1;
+
+  memset(counts, 0, (size_t)n * sp->nscores * sizeof(uint32_t));
+  for (int k = 0; k < n; k++)
+  {
+    mmDecode(sp, guesses[k], g[k]);
+    if (sp->distinct)
+      mmPackSeq(sp, g[k], &gp[k]);
+  }
+
+  for (uint32_t i = 0; i < st->nchunks; i++)
+  {
+    const struct mmChunk *c = &st->chunks[i];
+    mmCode base = (mmCode)c->key << MM_CHUNK_BITS;
+    uint32_t m = chunkExpand(c, st->scratch);
+
+    for (uint32_t j = 0; j < m; j++)
+    {
+      seqTo(sp, s, &at, base + st->scratch[j]);
+      if (sp->distinct)
+      {
+        mmPackSeq(sp, s, &ps);
+        for (int k = 0; k < n; k++)
+          counts[k * sp->nscores + sp->scoreIdx[mmScorePacked(sp, &ps, &gp[k])]]++;
+        continue;
+      }
+      for (int k = 0; k < n; k++)
+        counts[k * sp->nscores + sp->scoreIdx[mmScoreSeq(sp, s, g[k])]]++;
+    }
+  }
+  st->scorings += st->count * n;
+}
+
+/* a guess for the current candidates: the best, by sum of squared partition
+ * sizes, of up to @maxGuesses@ random candidates, as many as fit into a pass
+ * of about @budget@ scorings (at least one) */
+mmCode mmStreamChoose(struct mmStream *st, struct mmRng *rng, int maxGuesses, uint64_t budget)
+{
+  const struct mmSpace *sp = st->sp;
+  mmCode guesses[maxGuesses > 1 ? maxGuesses : 1];
+  uint32_t *counts;
+  uint64_t best = UINT64_MAX;
+  mmCode bestGuess;
+  int n = 0;
+
+  if (st->count <= 1)
+    return st->count == 1 ? mmStreamSelect(st, 0) : sp->size;
+
+  for (int tries = 0; n < maxGuesses && (n == 0 || (uint64_t)(n + 1) * st->count <= budget) &&
+                      (uint64_t)n < st->count && tries < 4 * maxGuesses; tries++)
+  {
+    mmCode g = mmStreamSelect(st, mmRngBelow(rng, st->count));
+    int dup = 0;
+
+    for (int k = 0; k < n; k++)
+      dup |= guesses[k] == g;
+    if (!dup)
+      guesses[n++] = g;
+  }
+  bestGuess = n > 0 ? guesses[0] : mmStreamSelect(st, 0);
+  if (n == 1 || (counts = (uint32_t *)streamAlloc(st, n * sp->nscores * sizeof(uint32_t))) == NULL)
+    return bestGuess;
+
+  mmStreamPartition(st, guesses, n, counts);
+  for (int k = 0; k < n; k++)
+  {
+    uint64_t q = 0;
+
+    for (int idx = 0; idx < sp->nscores; idx++)
+      q += (uint64_t)counts[k * sp->nscores + idx] * counts[k * sp->nscores + idx];
+    if (q < best)
+    {
+      best = q;
+      bestGuess = guesses[k];
+    }
+  }
+  streamRelease(st, counts, n * sp->nscores * sizeof(uint32_t));
+  return bestGuess;
+}
+
+/* ======================================================= */
+/* SECTION: statistics                                     */
+/* ------------------------------------------------------- */
+
+/* containers by kind, memory against the cap, and peak RSS of the process */
+void mmStreamReport(const struct mmStream *st, FILE *f)
+{
+  static const char *names[MM_CHUNK_TYPES] = {"array", "bitmap", "run"};
+  uint32_t kinds[MM_CHUNK_TYPES] = {0};
+  struct rusage ru;
+
+  for (uint32_t i = 0; i < st->nchunks; i++)
+    kinds[st->chunks[i].type]++;
+  fprintf(f, "%llu candidates in %u chunks (", (unsigned long long)st->count, st->nchunks);
+  for (int t = 0; t < MM_CHUNK_TYPES; t++)
+    fprintf(f, "%s%u %s", t ? ", " : "", kinds[t], names[t]);
+  fprintf(f, "), %zu bytes; peak %zu of %zu bytes allowed", st->bytes, st->peakBytes, st->capBytes);
+  if (getrusage(RUSAGE_SELF, &ru) == 0)
+    fprintf(f, ", peak RSS %ld kB", ru.ru_maxrss);
+  fprintf(f, "\n");
+}
@@ -0,0 +1,71 @@
+/*
+ * Streaming solver for code spaces too big for bitsets and mask tables on a
+ * Pi, e.g. 6x9 (531441 codes) or 8x10 (10^8 codes).
+ *
+ * The candidates are kept in compressed containers, one per chunk of 65536
+ * consecutive codes (as in roaring bitmaps): a sorted array of the low 16 bits
+ * for sparse chunks, a bitmap for dense ones, or runs of consecutive codes,
+ * whichever is smallest. At the start every chunk is a single run, so the full
+ * space takes a few bytes per chunk. Codes are never materialised as a whole:
+ * filtering and guess evaluation expand one chunk at a time into a scratch
+ * buffer and stream over it, scoring a whole batch of guesses per pass.
+ *
+ * All allocations are counted against a hard cap set by the caller;
+ * operations that would exceed it fail, leaving the set unusable.
+ */
+
+#ifndef MM_STREAM_H
+#define MM_STREAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mm-solver.h"
+#include "mm-rng.h"
+
+#define MM_CHUNK_BITS 16
+#define MM_CHUNK_SIZE (1u << MM_CHUNK_BITS)
+#define MM_ARRAY_MAX 4096 // beyond this, a bitmap is never bigger
+
+/* container kinds */
+enum mmChunkType
+{
+  MM_CHUNK_ARRAY,  // n sorted low halves
+  MM_CHUNK_BITMAP, // MM_CHUNK_SIZE bits
+  MM_CHUNK_RUN,    // n (start, length - 1) pairs
+  MM_CHUNK_TYPES
+};
+
+struct mmChunk
+{
+  uint16_t key;  // code >> MM_CHUNK_BITS
+  uint16_t type; // enum mmChunkType
+  uint32_t card; // codes in the chunk
+  uint32_t n;    // entries of an array, or runs
+  void *data;
+};
+
+struct mmStream
+{
+  const struct mmSpace *sp;
+  struct mmChunk *chunks; // in order of key; empty chunks are dropped
+  uint32_t nchunks, maxChunks;
+  uint64_t count;
+  uint16_t *scratch; // one expanded chunk
+  size_t bytes, peakBytes, capBytes;
+  uint64_t scorings; // pairs scored so far, for the throughput
+};
+
+int mmStreamInit(struct mmStream *st, const struct mmSpace *sp, size_t capBytes);
+int mmStreamReset(struct mmStream *st);
+void mmStreamFree(struct mmStream *st);
+
+int mmStreamFilter(struct mmStream *st, mmCode guess, int score);
+mmCode mmStreamSelect(struct mmStream *st, uint64_t rank);
+void mmStreamPartition(struct mmStream *st, const mmCode *guesses, int n, uint32_t *counts);
+mmCode mmStreamChoose(struct mmStream *st, struct mmRng *rng, int maxGuesses, uint64_t budget);
+
+void mmStreamReport(const struct mmStream *st, FILE *f);
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Per-thread event rings and trace files, see mm-trace.h.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "mm-trace.h"
+
+const char *mmTraceNames[MM_EV_COUNT] = {
+  "none", "lcd command", "lcd home", "lcd clear", "lcd puts",
+  "button", "round", "input", "match", "dump", "lcd glyph",
+};
+
+#ifndef MM_NO_TRACE
+
+_Thread_local struct mmTraceRing mmTraceLocal;
+
+/* the rings of all registered threads */
+static struct mmTraceRing *rings[MM_TRACE_MAX_THREADS];
+static int nrings;
+
+/* where to dump to; set once, before the handlers are installed */
+static char tracePath[256];
+
+/* signal of a pending dump request, 0 for none */
+static volatile sig_atomic_t dumpRequest;
+
+/* include the calling thread's ring in dumps; the thread must outlive it */
+void mmTraceRegister(void)
+{
+  int n = __atomic_fetch_add(&nrings, 1, __ATOMIC_ACQ_REL);
+
+  if (n < MM_TRACE_MAX_THREADS)
+    __atomic_store_n(&rings[n], &mmTraceLocal, __ATOMIC_RELEASE);
+}
+
+static int writeAll(int fd, const void *buf, size_t len)
+{
+  const char *p = (const char *)buf;
+
+  while (len > 0)
+  {
+    ssize_t w = write(fd, p, len);
+
+    if (w <= 0)
+      return -1;
+    p += w;
+    len -= w;
+  }
+  return 0;
+}
+
+/* write all rings to @path@; async-signal-safe, so it can run in a handler */
+int mmTraceDump(const char *path)
+{
+  struct mmTraceHeader hdr;
+  int n = __atomic_load_n(&nrings, __ATOMIC_ACQUIRE), fd, ok = 1;
+
+  if (n > MM_TRACE_MAX_THREADS)
+    n = MM_TRACE_MAX_THREADS;
+  if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0)
+    return -1;
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, MM_TRACE_MAGIC, 4);
+  hdr.endian = MM_TRACE_ENDIAN;
+  hdr.version = MM_TRACE_VERSION;
+  hdr.headerSize = sizeof(hdr);
+  hdr.eventSize = sizeof(struct mmTraceEvent);
+  hdr.nthreads = n;
+  ok = writeAll(fd, &hdr, sizeof(hdr)) == 0;
+
+  for (int t = 0; t < n && ok; t++)
+  {
+    const struct mmTraceRing *r = __atomic_load_n(&rings[t], __ATOMIC_ACQUIRE);
+    uint32_t head = r != NULL ? __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) : 0;
+    uint32_t count = head < MM_TRACE_SIZE ? head : MM_TRACE_SIZE;
+    uint32_t first = (head - count) & (MM_TRACE_SIZE - 1);
+    uint32_t tail = MM_TRACE_SIZE - first < count ? MM_TRACE_SIZE - first : count;
+    struct mmTraceBlock blk = {t, count, head};
+
+    // the ring wraps around, so the oldest events are at @first@
+    ok = writeAll(fd, &blk, sizeof(blk)) == 0 &&
+         (count == 0 || (writeAll(fd, &r->ev[first], tail * sizeof(r->ev[0])) == 0 &&
+                         writeAll(fd, &r->ev[0], (count - tail) * sizeof(r->ev[0])) == 0));
+  }
+  if (close(fd) != 0)
+    ok = 0;
+  return ok ? 0 : -1;
+}
+
+/* the handler only notes the request: it may have interrupted the owner of the
+ * thread-local ring in the middle of recording an event */
+static void onSignal(int signum)
+{
+  dumpRequest = signum;
+}
+
+/* dump if a signal asked for it since the last call; for the main loop */
+void mmTracePoll(void)
+{
+  int signum = dumpRequest;
+
+  if (signum == 0)
+    return;
+  dumpRequest = 0;
+  MM_TRACE(MM_EV_DUMP, signum, 0);
+  mmTraceDump(tracePath);
+}
+
+static void onExit(void)
+{
+  MM_TRACE(MM_EV_DUMP, 0, 0);
+  mmTraceDump(tracePath);
+}
+
+/* trace the calling thread; with a @path@, dump there at exit and when polled after a SIGUSR2 */
+void mmTraceInit(const char *path)
+{
+  struct sigaction sa;
+
+  mmTraceRegister();
+  if (path == NULL)
+    return;
+  strncpy(tracePath, path, sizeof(tracePath) - 1);
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = onSignal;
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGUSR2, &sa, NULL);
+  atexit(onExit);
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Event tracing for the hot paths: a fixed-size ring of binary events per
+ * thread, written with a handful of stores and no locks, instead of printing
+ * to stderr while the timing matters. The rings are written to a file at exit
+ * or, after a SIGUSR2, at the next mmTracePoll() of the main loop, and
+ * rendered as a timeline by mm-tracedump.
+ *
+ * File layout (host byte order, checked via @endian@):
+ *   struct mmTraceHeader
+ *   nthreads x { struct mmTraceBlock; nevents x struct mmTraceEvent }
+ * with the events of a block in chronological order.
+ *
+ * Tracing is compiled in by default; -DMM_NO_TRACE removes it.
+ */
+
+#ifndef MM_TRACE_H
+#define MM_TRACE_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define MM_TRACE_MAGIC "MMTR"
+#define MM_TRACE_VERSION 1
+#define MM_TRACE_ENDIAN 0x01020304
+
+#define MM_TRACE_SIZE 4096 // events per thread, a power of 2
+#define MM_TRACE_MAX_THREADS 16
+
+/* event ids; keep mmTraceNames in mm-trace.c in sync */
+enum mmTraceId
+{
+  MM_EV_NONE,
+  MM_EV_LCD_CMD,    // a: command byte
+  MM_EV_LCD_HOME,   //
+  MM_EV_LCD_CLEAR,  //
+  MM_EV_LCD_PUTS,   // a: cursor x, b: length of the string
+  MM_EV_BUTTON,     // a: pin
+  MM_EV_ROUND,      // a: round number
+  MM_EV_INPUT,      // a: turn, b: number of button presses
+  MM_EV_MATCH,      // a: exact, b: approximate
+  MM_EV_DUMP,       // a: signal number, 0 at exit
+  MM_EV_LCD_GLYPH,  // a: CGRAM slot uploaded
+  MM_EV_COUNT
+};
+
+struct mmTraceEvent
+{
+  uint64_t ns; // CLOCK_MONOTONIC
+  uint16_t id;
+  uint16_t a;
+  uint32_t b;
+};
+
+struct mmTraceHeader
+{
+  char magic[4];
+  uint32_t endian;
+  uint16_t version;
+  uint16_t headerSize;
+  uint16_t eventSize;
+  uint16_t nthreads;
+};
+
+struct mmTraceBlock
+{
+  uint32_t thread;  // registration order
+  uint32_t nevents; // at most MM_TRACE_SIZE; older ones were overwritten
+  uint64_t total;   // events recorded in all, including overwritten ones
+};
+
+/* one ring per thread; only the owning thread writes to it */
+struct mmTraceRing
+{
+  uint32_t head; // events recorded so far
+  struct mmTraceEvent ev[MM_TRACE_SIZE];
+};
+
+extern const char *mmTraceNames[MM_EV_COUNT];
+
+#ifndef MM_NO_TRACE
+
+extern _Thread_local struct mmTraceRing mmTraceLocal;
+
+void mmTraceInit(const char *path);
+void mmTraceRegister(void);
+void mmTracePoll(void);
+int mmTraceDump(const char *path);
+
+static inline void mmTrace(enum mmTraceId id, uint32_t a, uint32_t b)
+{
+  struct mmTraceRing *r = &mmTraceLocal;
+  struct mmTraceEvent *e = &r->ev[r->head & (MM_TRACE_SIZE - 1)];
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  e->ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  e->id = id;
+  e->a = a;
+  e->b = b;
+  // publish after the event itself, for a dump from a signal handler
+  __atomic_store_n(&r->head, r->head + 1, __ATOMIC_RELEASE);
+}
+
+#define MM_TRACE(id, a, b) mmTrace(id, a, b)
+
+#else
+
+#define mmTraceInit(path) ((void)0)
+#define mmTraceRegister() ((void)0)
+#define mmTracePoll() ((void)0)
+#define MM_TRACE(id, a, b) ((void)0)
+
+#endif
+
+#endif
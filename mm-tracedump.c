@@ -0,0 +1,124 @@
+/*
+  Render a trace file written by the game (option -T, see mm-trace.h) as a
+  timeline, with the events of all threads merged by time.
+
+$ sudo ./master-mind -T game.trace
+$ ./mm-tracedump game.trace
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mm-trace.h"
+
+struct event
+{
+  struct mmTraceEvent ev;
+  uint32_t thread;
+};
+
+static int byTime(const void *x, const void *y)
+{
+  const struct event *a = (const struct event *)x, *b = (const struct event *)y;
+
+  return a->ev.ns < b->ev.ns ? -1 : a->ev.ns > b->ev.ns;
+}
+
+/* the arguments of an event, in the terms of its id (see enum mmTraceId) */
+static void showArgs(const struct mmTraceEvent *e)
+{
+  switch (e->id) {
+  case MM_EV_LCD_CMD:
+    printf("0x%02x", e->a);
+    break;
+  case MM_EV_LCD_PUTS:
+    printf("x=%u len=%u", e->a, e->b);
+    break;
+  case MM_EV_BUTTON:
+    printf("pin %u", e->a);
+    break;
+  case MM_EV_ROUND:
+    printf("%u", e->a);
+    break;
+  case MM_EV_INPUT:
+    printf("turn %u: %u presses", e->a, e->b);
+    break;
+  case MM_EV_MATCH:
+    printf("exact %u approx %u", e->a, e->b);
+    break;
+  case MM_EV_LCD_GLYPH:
+    printf("slot %u", e->a);
+    break;
+  case MM_EV_DUMP:
+    if (e->a != 0)
+      printf("signal %u", e->a);
+    else
+      printf("at exit");
+    break;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  struct mmTraceHeader hdr;
+  struct event *evs = NULL;
+  size_t nevs = 0;
+  uint64_t t0, prev;
+  FILE *f;
+
+  if (argc != 2 || strcmp(argv[1], "-h") == 0) {
+    fprintf(stderr, "Usage: %s <trace file>\n", argv[0]);
+    exit(argc == 2 ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  if ((f = fopen(argv[1], "rb")) == NULL) {
+    perror(argv[1]);
+    exit(EXIT_FAILURE);
+  }
+  if (fread(&hdr, sizeof(hdr), 1, f) != 1 || memcmp(hdr.magic, MM_TRACE_MAGIC, 4) != 0 ||
+      hdr.endian != MM_TRACE_ENDIAN || hdr.version != MM_TRACE_VERSION ||
+      hdr.headerSize != sizeof(hdr) || hdr.eventSize != sizeof(struct mmTraceEvent)) {
+    fprintf(stderr, "%s: not a trace file of this version\n", argv[1]);
+    exit(EXIT_FAILURE);
+  }
+
+  for (int t = 0; t < hdr.nthreads; t++) {
+    struct mmTraceBlock blk;
+
+    if (fread(&blk, sizeof(blk), 1, f) != 1 || blk.nevents > MM_TRACE_SIZE) {
+      fprintf(stderr, "%s: truncated\n", argv[1]);
+      exit(EXIT_FAILURE);
+    }
+    if (blk.total > blk.nevents)
+      fprintf(stderr, "thread %u: %llu older events were overwritten\n", blk.thread,
+	      (unsigned long long)(blk.total - blk.nevents));
+    evs = (struct event *)realloc(evs, (nevs + blk.nevents) * sizeof(*evs));
+    for (uint32_t i = 0; i < blk.nevents; i++, nevs++) {
+      if (fread(&evs[nevs].ev, sizeof(evs[nevs].ev), 1, f) != 1) {
+	fprintf(stderr, "%s: truncated\n", argv[1]);
+	exit(EXIT_FAILURE);
+      }
+      evs[nevs].thread = blk.thread;
+    }
+  }
+  fclose(f);
+  if (nevs == 0)
+    return 0;
+
+  qsort(evs, nevs, sizeof(*evs), byTime);
+  printf("%12s %10s  %-3s %-12s %s\n", "time [ms]", "+delta", "thr", "event", "args");
+  t0 = prev = evs[0].ev.ns;
+  for (size_t i = 0; i < nevs; i++) {
+    const struct mmTraceEvent *e = &evs[i].ev;
+
+    printf("%12.3f %10.3f  t%-2u %-12s ", (e->ns - t0) / 1e6, (e->ns - prev) / 1e6, evs[i].thread,
+	   e->id < MM_EV_COUNT ? mmTraceNames[e->id] : "?");
+    showArgs(e);
+    printf("\n");
+    prev = e->ns;
+  }
+  free(evs);
+  return 0;
+}
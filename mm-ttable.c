@@ -0,0 +1,151 @@
+/*
+ * Lock-free transposition table for the strategy search; see mm-ttable.h.
+ *
+ * Layout of the data word:
+ *   bits  0..31  best guess
+ *   bits 32..55  cost (sum of guesses over the candidates)
+ *   bits 56..57  kind of cost (MM_TT_EXACT or MM_TT_LOWER)
+ *   bits 58..63  log2 of the number of candidates, the value of the entry
+ * Replacement: a matching key is overwritten, then an empty entry is used,
+ * otherwise the entry for the smallest subproblem in the bucket is evicted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "mm-ttable.h"
+
+#define COST_MAX 0xFFFFFF
+
+/* the largest table with a power-of-two number of buckets within @budget@ bytes */
+int mmTTInit(struct mmTTable *tt, size_t budget)
+{
+  size_t bucket = MM_TT_WAYS * sizeof(struct mmTTEntry);
+
+  tt->nbuckets = 1;
+  while (tt->nbuckets * 2 * bucket <= budget)
+    tt->nbuckets *= 2;
+  tt->bytes = tt->nbuckets * bucket;
+  if (posix_memalign((void **)&tt->e, 64, tt->bytes) != 0)
+  {
+    tt->e = NULL;
+    return -1;
+  }
+  memset(tt->e, 0, tt->bytes);
+  return 0;
+}
+
+void mmTTFree(struct mmTTable *tt)
+{
+  free(tt->e);
+  tt->e = NULL;
+}
+
+static inline uint64_t mix64(uint64_t h)
+{
+  h ^= h >> 31;
+  h *= 0x7FB5D329728EA185ULL;
+  h ^= h >> 27;
+  h *= 0x81DADEF4BC2DD44DULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/* 64-bit key for the candidate set @set@ with @depth@ guesses left; never 0 */
+uint64_t mmTTKey(const struct mmBitset *set, int depth)
+{
+  uint64_t h = 0x9E3779B97F4A7C15ULL * (depth + 1);
+
+  for (uint32_t k = 0; k < set->nwords; k++)
+    h = mix64(h ^ set->w[k]) + k;
+  h = mix64(h);
+  return h ? h : 1;
+}
+
+static inline struct mmTTEntry *bucketOf(struct mmTTable *tt, uint64_t key)
+{
+  return tt->e + (key & (tt->nbuckets - 1)) * MM_TT_WAYS;
+}
+
+int mmTTProbe(struct mmTTable *tt, uint64_t key, struct mmTTResult *res, struct mmTTStats *st)
+{
+  struct mmTTEntry *b = bucketOf(tt, key);
+
+  st->probes++;
+  for (int i = 0; i < MM_TT_WAYS; i++)
+  {
+    uint64_t data = atomic_load_explicit(&b[i].data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&b[i].check, memory_order_relaxed);
+
+    if ((check ^ data) == key && data != 0)
+    {
+      res->guess = (mmCode)data;
+      res->cost = (data >> 32) & COST_MAX;
+      res->bound = (data >> 56) & 3;
+      st->hits++;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* store the result for a subproblem of @count@ candidates */
+void mmTTStore(struct mmTTable *tt, uint64_t key, uint32_t count, const struct mmTTResult *res, struct mmTTStats *st)
+{
+  struct mmTTEntry *b = bucketOf(tt, key);
+  uint64_t weight = 63 - __builtin_clzll((uint64_t)count | 1);
+  uint64_t data, victimWeight = 64;
+  int victim = 0, empty = 0;
+
+  if (res->cost > COST_MAX)
+    return;
+  data = (uint64_t)res->guess | ((uint64_t)res->cost << 32) | ((uint64_t)res->bound << 56) | (weight << 58);
+
+  for (int i = 0; i < MM_TT_WAYS; i++)
+  {
+    uint64_t d = atomic_load_explicit(&b[i].data, memory_order_relaxed);
+    uint64_t c = atomic_load_explicit(&b[i].check, memory_order_relaxed);
+
+    if (d == 0 || (c ^ d) == key)
+    {
+      victim = i;
+      empty = 1;
+      break;
+    }
+    if ((d >> 58) < victimWeight)
+    {
+      victim = i;
+      victimWeight = d >> 58;
+    }
+  }
+  if (!empty)
+  {
+    if (victimWeight > weight)
+      return; // keep the bigger subproblems
+    st->replaced++;
+  }
+
+  atomic_store_explicit(&b[victim].data, data, memory_order_relaxed);
+  atomic_store_explicit(&b[victim].check, key ^ data, memory_order_relaxed);
+  st->stores++;
+}
+
+/* print hit rate, replacements and memory use of the table */
+void mmTTReport(const struct mmTTable *tt, const struct mmTTStats *st, FILE *f)
+{
+  uint64_t used = 0, n = tt->nbuckets * MM_TT_WAYS;
+
+  for (uint64_t i = 0; i < n; i++)
+    if (atomic_load_explicit(&tt->e[i].data, memory_order_relaxed) != 0)
+      used++;
+
+  fprintf(f, "Transposition table: %zu KB, %llu of %llu entries used (%.1f%%)\n",
+          tt->bytes / 1024, (unsigned long long)used, (unsigned long long)n, 100.0 * used / n);
+  fprintf(f, "  %llu probes, %llu hits (%.1f%%), %llu stores, %llu replaced\n",
+          (unsigned long long)st->probes, (unsigned long long)st->hits,
+          st->probes ? 100.0 * st->hits / st->probes : 0.0,
+          (unsigned long long)st->stores, (unsigned long long)st->replaced);
+}
@@ -0,0 +1,61 @@
+/*
+ * Transposition table for the strategy search: remembers the best guess and
+ * cost of subproblems (a candidate set with a number of guesses left), which
+ * are reached through many different guess/feedback histories.
+ *
+ * The table has a fixed size, chosen from a memory budget, and is shared
+ * between threads without locks: each entry stores key^data next to data, so
+ * a torn entry simply fails the key check and reads as a miss.
+ */
+
+#ifndef MM_TTABLE_H
+#define MM_TTABLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "mm-solver.h"
+
+#define MM_TT_WAYS 4 // entries per bucket; one bucket is one 64 byte cache line
+
+/* kinds of cost stored */
+#define MM_TT_EXACT 1 // the cost is optimal
+#define MM_TT_LOWER 2 // the search was cut off; the cost is a lower bound
+
+struct mmTTEntry
+{
+  _Atomic uint64_t check; // key ^ data
+  _Atomic uint64_t data;
+};
+
+struct mmTTable
+{
+  struct mmTTEntry *e;
+  uint64_t nbuckets; // power of two
+  size_t bytes;
+};
+
+/* result of a successful probe */
+struct mmTTResult
+{
+  mmCode guess;
+  uint32_t cost;
+  int bound;
+};
+
+/* counters, kept per thread and added up for the report */
+struct mmTTStats
+{
+  uint64_t probes, hits, stores, replaced;
+};
+
+int mmTTInit(struct mmTTable *tt, size_t budget);
+void mmTTFree(struct mmTTable *tt);
+uint64_t mmTTKey(const struct mmBitset *set, int depth);
+int mmTTProbe(struct mmTTable *tt, uint64_t key, struct mmTTResult *res, struct mmTTStats *st);
+void mmTTStore(struct mmTTable *tt, uint64_t key, uint32_t count, const struct mmTTResult *res, struct mmTTStats *st);
+void mmTTReport(const struct mmTTable *tt, const struct mmTTStats *st, FILE *f);
+
+#endif